@@ -0,0 +1,21 @@
+"""Pseudo-builders for building and running micro-benchmarks.
+"""
+
+def exists(env):
+    return True
+
+def build_benchmark(env, target, source, **kwargs):
+    result = env.Program(target, source, **kwargs)
+    buildAlias = env.Alias('build-' + target, result)
+    env.Alias('build-benchmarks', buildAlias)
+    # Each benchmark program writes its results as JSON next to itself.
+    runAlias = env.Alias('run-' + target, [result],
+        "%s --output=%s.json" % (result[0].abspath, result[0].abspath))
+    env.AlwaysBuild(runAlias)
+    env.Alias('benchmarks', runAlias)
+    env.AlwaysBuild('benchmarks')
+
+    return result
+
+def generate(env):
+    env.AddMethod(build_benchmark, 'Benchmark')
@@ -0,0 +1,391 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/benchmark/benchmark.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace benchmark {
+
+namespace {
+
+    AtomicUInt64 totalBytesAllocated;
+    AtomicUInt64 totalAllocations;
+
+    void recordAllocation(size_t size) {
+        totalBytesAllocated.fetchAndAdd(size);
+        totalAllocations.fetchAndAdd(1);
+    }
+
+    void* countedNew(size_t size) {
+#if !defined(MONGO_BENCHMARK_WRAP_MALLOC)
+        recordAllocation(size);
+#endif
+        void* p = std::malloc(size ? size : 1);
+        if (!p)
+            throw std::bad_alloc();
+        return p;
+    }
+
+} // namespace
+
+} // namespace benchmark
+} // namespace mongo
+
+#if defined(MONGO_BENCHMARK_WRAP_MALLOC)
+// The build links benchmarks with --wrap=malloc and friends so that raw malloc calls, such as
+// BufBuilder's, are counted along with operator new.
+extern "C" {
+    void* __real_malloc(size_t size);
+    void* __real_calloc(size_t count, size_t size);
+    void* __real_realloc(void* p, size_t size);
+
+    void* __wrap_malloc(size_t size) {
+        mongo::benchmark::recordAllocation(size);
+        return __real_malloc(size);
+    }
+
+    void* __wrap_calloc(size_t count, size_t size) {
+        mongo::benchmark::recordAllocation(count * size);
+        return __real_calloc(count, size);
+    }
+
+    void* __wrap_realloc(void* p, size_t size) {
+        mongo::benchmark::recordAllocation(size);
+        return __real_realloc(p, size);
+    }
+}
+#endif
+
+// Dynamic exception specifications are deprecated in C++11, which no longer needs one here.
+#if __cplusplus >= 201103L
+#define MONGO_BENCHMARK_THROW_BAD_ALLOC
+#else
+#define MONGO_BENCHMARK_THROW_BAD_ALLOC throw(std::bad_alloc)
+#endif
+
+void* operator new(size_t size) MONGO_BENCHMARK_THROW_BAD_ALLOC {
+    return mongo::benchmark::countedNew(size);
+}
+
+void* operator new[](size_t size) MONGO_BENCHMARK_THROW_BAD_ALLOC {
+    return mongo::benchmark::countedNew(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) throw() {
+    try {
+        return mongo::benchmark::countedNew(size);
+    }
+    catch (const std::bad_alloc&) {
+        return NULL;
+    }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) throw() {
+    try {
+        return mongo::benchmark::countedNew(size);
+    }
+    catch (const std::bad_alloc&) {
+        return NULL;
+    }
+}
+
+void operator delete(void* p) throw() {
+    std::free(p);
+}
+
+void operator delete[](void* p) throw() {
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) throw() {
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) throw() {
+    std::free(p);
+}
+
+namespace mongo {
+namespace benchmark {
+
+namespace {
+
+    struct RegisteredBenchmark {
+        std::string name;
+        BenchmarkFunction function;
+        ShapeBenchmarkFunction shapeFunction;
+        DocumentShape shape;
+    };
+
+    std::vector<RegisteredBenchmark>& registeredBenchmarks() {
+        // Constructed on first use, since registrations run during static initialization.
+        static std::vector<RegisteredBenchmark> benchmarks;
+        return benchmarks;
+    }
+
+    const long long kMaxIterations = 1000 * 1000 * 1000;
+
+    BSONObj buildSmallFlat() {
+        BSONObjBuilder b;
+        b.append("_id", OID("53e3b4c3e7a8f3b1c0a1d2e3"));
+        b.append("name", "Jane Doe");
+        b.append("email", "jane.doe@example.com");
+        b.append("age", 42);
+        b.append("active", true);
+        b.append("score", 97.5);
+        b.append("visits", 1234567890123LL);
+        b.appendDate("createdAt", Date_t(1407431875000ULL));
+        b.append("city", "New York");
+        b.append("zip", "10001");
+        b.appendNull("referrer");
+        b.append("plan", "premium");
+        return b.obj();
+    }
+
+    BSONObj buildWide() {
+        BSONObjBuilder b;
+        for (int i = 0; i < 500; ++i) {
+            const std::string name = str::stream() << "field" << i;
+            switch (i % 3) {
+            case 0: b.append(name, i); break;
+            case 1: b.append(name, i * 1.5); break;
+            default: b.append(name, std::string(16, 'a' + i % 26)); break;
+            }
+        }
+        return b.obj();
+    }
+
+    BSONObj buildDeeplyNested() {
+        BSONObj doc = BSON("value" << 1 << "label" << "leaf");
+        for (int depth = 0; depth < 50; ++depth)
+            doc = BSON("level" << depth << "child" << doc);
+        return doc;
+    }
+
+    BSONObj buildLargeBinary() {
+        std::vector<char> data(1024 * 1024);
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = static_cast<char>(i * 31);
+
+        BSONObjBuilder b;
+        b.append("_id", OID("53e3b4c3e7a8f3b1c0a1d2e4"));
+        b.append("filename", "photo.jpg");
+        b.append("length", static_cast<int>(data.size()));
+        b.appendBinData("data", data.size(), BinDataGeneral, &data[0]);
+        return b.obj();
+    }
+
+    void runOnce(const RegisteredBenchmark& benchmark, State* state) {
+        if (benchmark.shapeFunction)
+            benchmark.shapeFunction(*state, documentOfShape(benchmark.shape));
+        else
+            benchmark.function(*state);
+        state->pauseTiming();
+    }
+
+    // Runs with increasing iteration counts until a run takes at least the minimum time.
+    long long runUntilMinTime(const RegisteredBenchmark& benchmark, const Options& options,
+                              long long* elapsedMicros, long long* bytesAllocated,
+                              long long* allocations) {
+        const long long minMicros = options.minTimeMillis * 1000LL;
+        long long iterations = 1;
+
+        while (true) {
+            State state(iterations);
+            runOnce(benchmark, &state);
+
+            *elapsedMicros = state.elapsedMicros();
+            *bytesAllocated = state.bytesAllocated();
+            *allocations = state.allocations();
+            if (*elapsedMicros >= minMicros || iterations >= kMaxIterations)
+                return iterations;
+
+            // Aim 20% past the minimum, growing at most 100x at a time.
+            long long next = *elapsedMicros > 0
+                ? minMicros * 6 / 5 * iterations / *elapsedMicros
+                : iterations * 100;
+            next = std::min(next, iterations * 100);
+            next = std::max(next, iterations + 1);
+            iterations = std::min(next, kMaxIterations);
+        }
+    }
+
+#if !defined(__GNUC__)
+    // Compilers must assume something else may read a volatile, so stores to it are kept.
+    const void* volatile doNotOptimizeAwaySink = NULL;
+#endif
+
+} // namespace
+
+    const char* documentShapeName(DocumentShape shape) {
+        switch (shape) {
+        case kSmallFlat: return "SmallFlat";
+        case kWide: return "Wide";
+        case kDeeplyNested: return "DeeplyNested";
+        case kLargeBinary: return "LargeBinary";
+        case kNumDocumentShapes: break;
+        }
+        return "unknown";
+    }
+
+    const BSONObj& documentOfShape(DocumentShape shape) {
+        // Benchmarks run on one thread, so lazy initialization needs no locking.
+        static BSONObj documents[kNumDocumentShapes];
+
+        BSONObj& doc = documents[shape];
+        if (doc.isEmpty()) {
+            switch (shape) {
+            case kSmallFlat: doc = buildSmallFlat(); break;
+            case kWide: doc = buildWide(); break;
+            case kDeeplyNested: doc = buildDeeplyNested(); break;
+            case kLargeBinary: doc = buildLargeBinary(); break;
+            case kNumDocumentShapes: break;
+            }
+        }
+        return doc;
+    }
+
+    void doNotOptimizeAway(const void* p) {
+#if defined(__GNUC__)
+        asm volatile("" : : "r"(p) : "memory");
+#else
+        doNotOptimizeAwaySink = p;
+#endif
+    }
+
+    State::State(long long iterations)
+        : _iterations(iterations)
+        , _remaining(iterations)
+        , _started(false)
+        , _running(false)
+        , _bytesAtStart(0)
+        , _allocationsAtStart(0)
+        , _elapsedMicros(0)
+        , _bytesAllocated(0)
+        , _allocations(0)
+    {}
+
+    bool State::keepRunning() {
+        if (!_started) {
+            _started = true;
+            resumeTiming();
+        }
+
+        if (_remaining > 0) {
+            --_remaining;
+            return true;
+        }
+
+        pauseTiming();
+        return false;
+    }
+
+    void State::pauseTiming() {
+        if (!_running)
+            return;
+
+        _elapsedMicros += _timer.micros();
+        _bytesAllocated += totalBytesAllocated.load() - _bytesAtStart;
+        _allocations += totalAllocations.load() - _allocationsAtStart;
+        _running = false;
+    }
+
+    void State::resumeTiming() {
+        if (_running)
+            return;
+
+        _running = true;
+        _bytesAtStart = totalBytesAllocated.load();
+        _allocationsAtStart = totalAllocations.load();
+        _timer.reset();
+    }
+
+    Registration::Registration(const std::string& name, BenchmarkFunction function) {
+        RegisteredBenchmark benchmark;
+        benchmark.name = name;
+        benchmark.function = function;
+        benchmark.shapeFunction = NULL;
+        benchmark.shape = kNumDocumentShapes;
+        registeredBenchmarks().push_back(benchmark);
+    }
+
+    Registration::Registration(const std::string& name, ShapeBenchmarkFunction function) {
+        for (int i = 0; i < kNumDocumentShapes; ++i) {
+            const DocumentShape shape = static_cast<DocumentShape>(i);
+
+            RegisteredBenchmark benchmark;
+            benchmark.name = name + "/" + documentShapeName(shape);
+            benchmark.function = NULL;
+            benchmark.shapeFunction = function;
+            benchmark.shape = shape;
+            registeredBenchmarks().push_back(benchmark);
+        }
+    }
+
+    size_t runBenchmarks(const Options& options, std::ostream& out) {
+        const std::vector<RegisteredBenchmark>& benchmarks = registeredBenchmarks();
+        size_t numRun = 0;
+
+        out << "{ \"benchmarks\" : [";
+        for (size_t i = 0; i < benchmarks.size(); ++i) {
+            const RegisteredBenchmark& benchmark = benchmarks[i];
+            if (benchmark.name.find(options.filter) == std::string::npos)
+                continue;
+
+            long long elapsedMicros;
+            long long bytesAllocated;
+            long long allocations;
+            const long long iterations = runUntilMinTime(benchmark, options, &elapsedMicros,
+                                                         &bytesAllocated, &allocations);
+
+            const double nsPerOp = elapsedMicros * 1000.0 / iterations;
+            const double bytesPerOp = static_cast<double>(bytesAllocated) / iterations;
+            const double allocsPerOp = static_cast<double>(allocations) / iterations;
+
+            out << (numRun ? "," : "") << "\n    { "
+                << "\"name\" : \"" << escape(benchmark.name) << "\", "
+                << "\"iterations\" : " << iterations << ", "
+                << std::fixed << std::setprecision(2)
+                << "\"nsPerOp\" : " << nsPerOp << ", "
+                << "\"bytesPerOp\" : " << bytesPerOp << ", "
+                << "\"allocsPerOp\" : " << allocsPerOp << " }";
+
+            std::cerr << std::left << std::setw(48) << benchmark.name
+                      << std::right << std::setw(12) << iterations
+                      << std::fixed << std::setprecision(1)
+                      << std::setw(14) << nsPerOp << " ns/op"
+                      << std::setw(14) << bytesPerOp << " B/op"
+                      << std::setw(10) << allocsPerOp << " allocs/op" << std::endl;
+            ++numRun;
+        }
+        out << "\n] }" << std::endl;
+
+        return numRun;
+    }
+
+} // namespace benchmark
+} // namespace mongo
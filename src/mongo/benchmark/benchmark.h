@@ -0,0 +1,154 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ * A minimal micro-benchmark harness.
+ *
+ * Benchmarks are registered at static initialization time with MONGO_BENCHMARK or
+ * MONGO_BENCHMARK_EACH_SHAPE and run by benchmark_main.cpp, which reports ns/op, bytes
+ * allocated/op and allocations/op for each of them as JSON:
+ *
+ *     MONGO_BENCHMARK(OIDGen) {
+ *         while (state.keepRunning()) {
+ *             OID oid;
+ *             oid.init();
+ *         }
+ *     }
+ */
+
+#pragma once
+
+#include <iosfwd>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace benchmark {
+
+    /**
+     * The representative documents that MONGO_BENCHMARK_EACH_SHAPE benchmarks run against.
+     */
+    enum DocumentShape {
+        kSmallFlat,     // a dozen scalar fields, typical of an application record
+        kWide,          // several hundred top-level fields
+        kDeeplyNested,  // a single field nested fifty subdocuments deep
+        kLargeBinary,   // a few fields alongside a 1MB BinData payload
+        kNumDocumentShapes
+    };
+
+    /** @return the name used to report benchmarks run against 'shape'. */
+    const char* documentShapeName(DocumentShape shape);
+
+    /** @return the document of the given shape, built on first use. */
+    const BSONObj& documentOfShape(DocumentShape shape);
+
+    /**
+     * Passed to each benchmark function, which must run its operation once per iteration of
+     *
+     *     while (state.keepRunning()) { ... }
+     *
+     * Setup that should not be measured goes before the loop, or between pauseTiming() and
+     * resumeTiming() inside it.
+     */
+    class State {
+        MONGO_DISALLOW_COPYING(State);
+    public:
+        explicit State(long long iterations);
+
+        /** @return true until the operation has run the requested number of times. */
+        bool keepRunning();
+
+        /** Stops counting time and allocations until resumeTiming() is called. */
+        void pauseTiming();
+        void resumeTiming();
+
+        long long iterations() const { return _iterations; }
+        long long elapsedMicros() const { return _elapsedMicros; }
+        long long bytesAllocated() const { return _bytesAllocated; }
+        long long allocations() const { return _allocations; }
+
+    private:
+        const long long _iterations;
+        long long _remaining;
+        bool _started;
+        bool _running;
+
+        Timer _timer;
+        unsigned long long _bytesAtStart;
+        unsigned long long _allocationsAtStart;
+
+        long long _elapsedMicros;
+        long long _bytesAllocated;
+        long long _allocations;
+    };
+
+    /**
+     * Keeps the compiler from discarding a computation whose result a benchmark otherwise
+     * ignores. Defined out of line so that it cannot see what is done with 'p'.
+     */
+    void doNotOptimizeAway(const void* p);
+
+    typedef void (*BenchmarkFunction)(State& state);
+    typedef void (*ShapeBenchmarkFunction)(State& state, const BSONObj& doc);
+
+    /**
+     * Adds a benchmark to the global list. Use the MONGO_BENCHMARK macros rather than
+     * constructing these directly.
+     */
+    class Registration {
+        MONGO_DISALLOW_COPYING(Registration);
+    public:
+        Registration(const std::string& name, BenchmarkFunction function);
+
+        /** Registers 'function' once per DocumentShape, named "<name>/<shape>". */
+        Registration(const std::string& name, ShapeBenchmarkFunction function);
+    };
+
+    struct Options {
+        Options() : minTimeMillis(500) {}
+
+        // Only benchmarks whose names contain this are run.
+        std::string filter;
+
+        // Each benchmark is repeated with more iterations until a run takes at least this long.
+        int minTimeMillis;
+    };
+
+    /**
+     * Runs every registered benchmark selected by 'options' and writes the results to 'out' as
+     * a JSON document of the form
+     *
+     *     { "benchmarks" : [ { "name" : ..., "iterations" : ..., "nsPerOp" : ...,
+     *                          "bytesPerOp" : ..., "allocsPerOp" : ... }, ... ] }
+     *
+     * @return the number of benchmarks run.
+     */
+    size_t runBenchmarks(const Options& options, std::ostream& out);
+
+} // namespace benchmark
+} // namespace mongo
+
+#define MONGO_BENCHMARK(NAME)                                                   \
+    static void NAME(::mongo::benchmark::State& state);                         \
+    static ::mongo::benchmark::Registration NAME##Registration(#NAME, &NAME);   \
+    static void NAME(::mongo::benchmark::State& state)
+
+#define MONGO_BENCHMARK_EACH_SHAPE(NAME)                                        \
+    static void NAME(::mongo::benchmark::State& state, const ::mongo::BSONObj& doc); \
+    static ::mongo::benchmark::Registration NAME##Registration(#NAME, &NAME);   \
+    static void NAME(::mongo::benchmark::State& state, const ::mongo::BSONObj& doc)
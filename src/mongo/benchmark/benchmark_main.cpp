@@ -0,0 +1,85 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "mongo/benchmark/benchmark.h"
+#include "mongo/client/init.h"
+
+namespace {
+
+    bool parseOption(const std::string& arg, const std::string& name, std::string* value) {
+        const std::string prefix = "--" + name + "=";
+        if (arg.compare(0, prefix.size(), prefix) != 0)
+            return false;
+        *value = arg.substr(prefix.size());
+        return true;
+    }
+
+    int usage(const char* program) {
+        std::cerr << "usage: " << program
+                  << " [--filter=<substring>] [--min-time-millis=<n>] [--output=<file>]"
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+} // namespace
+
+int main(int argc, char **argv) {
+    mongo::benchmark::Options options;
+    std::string output;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string value;
+        if (parseOption(argv[i], "filter", &value)) {
+            options.filter = value;
+        }
+        else if (parseOption(argv[i], "min-time-millis", &value)) {
+            options.minTimeMillis = std::atoi(value.c_str());
+            if (options.minTimeMillis <= 0)
+                return usage(argv[0]);
+        }
+        else if (parseOption(argv[i], "output", &value)) {
+            output = value;
+        }
+        else {
+            return usage(argv[0]);
+        }
+    }
+
+    mongo::client::GlobalInstance instance;
+    if (!instance.initialized()) {
+        std::cerr << "failed to initialize the client driver: " << instance.status() << std::endl;
+        ::abort();
+    }
+
+    if (output.empty()) {
+        mongo::benchmark::runBenchmarks(options, std::cout);
+        return EXIT_SUCCESS;
+    }
+
+    std::ofstream out(output.c_str());
+    if (!out) {
+        std::cerr << "could not open " << output << " for writing" << std::endl;
+        return EXIT_FAILURE;
+    }
+    mongo::benchmark::runBenchmarks(options, out);
+    return out ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,114 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/benchmark/benchmark.h"
+#include "mongo/bson/bson_field_index.h"
+#include "mongo/bson/bson_validate.h"
+#include "mongo/db/jsobj.h"
+
+namespace {
+
+    using namespace mongo;
+
+    MONGO_BENCHMARK(BSONObjBuilderSmallFlat) {
+        const OID id("53e3b4c3e7a8f3b1c0a1d2e3");
+        while (state.keepRunning()) {
+            BSONObjBuilder b;
+            b.append("_id", id);
+            b.append("name", "Jane Doe");
+            b.append("email", "jane.doe@example.com");
+            b.append("age", 42);
+            b.append("active", true);
+            b.append("score", 97.5);
+            b.append("visits", 1234567890123LL);
+            b.appendDate("createdAt", Date_t(1407431875000ULL));
+            b.append("city", "New York");
+            b.append("zip", "10001");
+            b.appendNull("referrer");
+            b.append("plan", "premium");
+            BSONObj obj = b.obj();
+            benchmark::doNotOptimizeAway(obj.objdata());
+        }
+    }
+
+    MONGO_BENCHMARK_EACH_SHAPE(BSONObjBuilderCopyFields) {
+        while (state.keepRunning()) {
+            BSONObjBuilder b;
+            BSONObjIterator it(doc);
+            while (it.more())
+                b.append(it.next());
+            BSONObj obj = b.obj();
+            benchmark::doNotOptimizeAway(obj.objdata());
+        }
+    }
+
+    MONGO_BENCHMARK_EACH_SHAPE(BSONObjGetFieldFirst) {
+        const std::string name = doc.firstElementFieldName();
+        while (state.keepRunning()) {
+            BSONElement e = doc.getField(name);
+            benchmark::doNotOptimizeAway(e.rawdata());
+        }
+    }
+
+    MONGO_BENCHMARK_EACH_SHAPE(BSONObjGetFieldLast) {
+        std::string name;
+        BSONObjIterator it(doc);
+        while (it.more())
+            name = it.next().fieldName();
+
+        while (state.keepRunning()) {
+            BSONElement e = doc.getField(name);
+            benchmark::doNotOptimizeAway(e.rawdata());
+        }
+    }
+
+    MONGO_BENCHMARK_EACH_SHAPE(BSONObjGetFieldMissing) {
+        while (state.keepRunning()) {
+            BSONElement e = doc.getField("missing");
+            benchmark::doNotOptimizeAway(e.rawdata());
+        }
+    }
+
+    MONGO_BENCHMARK_EACH_SHAPE(BSONObjFieldIndexBuild) {
+        while (state.keepRunning()) {
+            BSONObjFieldIndex index(doc);
+            benchmark::doNotOptimizeAway(&index);
+        }
+    }
+
+    MONGO_BENCHMARK_EACH_SHAPE(BSONObjFieldIndexGetFieldLast) {
+        std::string name;
+        BSONObjIterator it(doc);
+        while (it.more())
+            name = it.next().fieldName();
+
+        const BSONObjFieldIndex index(doc);
+        while (state.keepRunning()) {
+            BSONElement e = index.getField(name);
+            benchmark::doNotOptimizeAway(e.rawdata());
+        }
+    }
+
+    MONGO_BENCHMARK_EACH_SHAPE(ValidateBSON) {
+        while (state.keepRunning()) {
+            Status status = validateBSON(doc.objdata(), doc.objsize());
+            benchmark::doNotOptimizeAway(&status);
+        }
+    }
+
+} // namespace
@@ -0,0 +1,248 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+/**
+ * End-to-end benchmarks of the driver against a LoopbackServer, which answers over real sockets
+ * without doing any database work, so the results measure driver-side overhead.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "mongo/benchmark/benchmark.h"
+#include "mongo/benchmark/loopback_server.h"
+#include "mongo/client/bulk_operation_builder.h"
+#include "mongo/client/dbclientcursor.h"
+#include "mongo/client/dbclientinterface.h"
+#include "mongo/client/streaming_bulk_writer.h"
+#include "mongo/client/write_result.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace {
+
+    using namespace mongo;
+    using benchmark::LoopbackServer;
+
+    const char kNamespace[] = "benchmark.collection";
+
+    LoopbackServer::Options serverOptions(const BSONObj& document, int numDocuments) {
+        LoopbackServer::Options options;
+        options.document = document;
+        options.numDocuments = numDocuments;
+        return options;
+    }
+
+    /**
+     * A LoopbackServer with one connection to it, set up before a benchmark's timed loop.
+     */
+    class LoopbackFixture {
+        MONGO_DISALLOW_COPYING(LoopbackFixture);
+    public:
+        explicit LoopbackFixture(const LoopbackServer::Options& options) : _server(options) {
+            std::string errmsg;
+            uassert(0, str::stream() << "could not connect to loopback server: " << errmsg,
+                    _conn.connect(_server.getServerHostAndPort(), errmsg));
+        }
+
+        ~LoopbackFixture() {
+            for (size_t i = 0; i < _extraConns.size(); ++i)
+                delete _extraConns[i];
+        }
+
+        DBClientConnection& conn() { return _conn; }
+
+        /** Opens another connection to the server, which the fixture deletes. */
+        DBClientBase* openConnection() {
+            std::auto_ptr<DBClientConnection> conn(new DBClientConnection);
+            std::string errmsg;
+            uassert(0, str::stream() << "could not connect to loopback server: " << errmsg,
+                    conn->connect(_server.getServerHostAndPort(), errmsg));
+            _extraConns.push_back(conn.release());
+            return _extraConns.back();
+        }
+
+    private:
+        // Declared first so that it outlives the connections.
+        LoopbackServer _server;
+        DBClientConnection _conn;
+        std::vector<DBClientBase*> _extraConns;
+    };
+
+    void iterateAll(DBClientConnection& conn, bool prefetch) {
+        std::auto_ptr<DBClientCursor> cursor = conn.query(kNamespace, Query());
+        if (prefetch)
+            cursor->enablePrefetch();
+        while (cursor->more()) {
+            BSONObj doc = cursor->nextSafe();
+            benchmark::doNotOptimizeAway(doc.objdata());
+        }
+    }
+
+    void bulkInsert(DBClientConnection& conn, const std::vector<BSONObj>& docs) {
+        BulkOperationBuilder bulk = conn.initializeUnorderedBulkOp(kNamespace);
+        for (size_t i = 0; i < docs.size(); ++i)
+            bulk.insert(docs[i]);
+
+        WriteResult result;
+        bulk.execute(&WriteConcern::acknowledged, &result);
+        benchmark::doNotOptimizeAway(&result);
+    }
+
+    // A connection factory which hands out the same connections, in turn, on every call.
+    DBClientBase* nextConnection(const std::vector<DBClientBase*>* conns, size_t* next) {
+        return (*conns)[(*next)++ % conns->size()];
+    }
+
+    void parallelInsert(DBClientConnection& conn,
+                        const std::vector<BSONObj>& docs,
+                        const std::vector<DBClientBase*>& extraConns) {
+        BulkOperationBuilder bulk = conn.initializeUnorderedBulkOp(kNamespace);
+        for (size_t i = 0; i < docs.size(); ++i)
+            bulk.insert(docs[i]);
+
+        size_t next = 0;
+        WriteResult result;
+        bulk.executeParallel(&WriteConcern::acknowledged, &result, extraConns.size() + 1,
+                             stdx::bind(&nextConnection, &extraConns, &next));
+        benchmark::doNotOptimizeAway(&result);
+    }
+
+    void streamingInsert(DBClientConnection& conn, const std::vector<BSONObj>& docs) {
+        StreamingBulkWriter writer(&conn, kNamespace, false, &WriteConcern::acknowledged);
+        for (size_t i = 0; i < docs.size(); ++i)
+            writer.insert(docs[i]);
+
+        WriteResult result;
+        writer.finish(&result);
+        benchmark::doNotOptimizeAway(&result);
+    }
+
+    MONGO_BENCHMARK(RunCommandPing) {
+        LoopbackFixture fixture(serverOptions(BSONObj(), 1));
+        while (state.keepRunning()) {
+            BSONObj info;
+            fixture.conn().runCommand("admin", BSON("ping" << 1), info);
+            benchmark::doNotOptimizeAway(info.objdata());
+        }
+    }
+
+    MONGO_BENCHMARK(RunCommandPingUnixSocket) {
+        LoopbackServer::Options options = serverOptions(BSONObj(), 1);
+        options.unixSocketPath = str::stream() << "/tmp/mongo-cxx-driver-benchmark-"
+                                               << ::getpid() << ".sock";
+
+        LoopbackFixture fixture(options);
+        while (state.keepRunning()) {
+            BSONObj info;
+            fixture.conn().runCommand("admin", BSON("ping" << 1), info);
+            benchmark::doNotOptimizeAway(info.objdata());
+        }
+    }
+
+    MONGO_BENCHMARK_EACH_SHAPE(FindOne) {
+        LoopbackFixture fixture(serverOptions(doc, 1));
+        while (state.keepRunning()) {
+            BSONObj found = fixture.conn().findOne(kNamespace, Query());
+            benchmark::doNotOptimizeAway(found.objdata());
+        }
+    }
+
+    MONGO_BENCHMARK_EACH_SHAPE(InsertAcknowledged) {
+        LoopbackFixture fixture(serverOptions(BSONObj(), 1));
+        while (state.keepRunning())
+            fixture.conn().insert(kNamespace, doc, 0, &WriteConcern::acknowledged);
+    }
+
+    MONGO_BENCHMARK(UpdateAcknowledged) {
+        LoopbackFixture fixture(serverOptions(BSONObj(), 1));
+        const BSONObj selector = BSON("_id" << 1);
+        const BSONObj update = BSON("$inc" << BSON("count" << 1));
+        while (state.keepRunning())
+            fixture.conn().update(kNamespace, selector, update, false, false,
+                                  &WriteConcern::acknowledged);
+    }
+
+    MONGO_BENCHMARK(RemoveAcknowledged) {
+        LoopbackFixture fixture(serverOptions(BSONObj(), 1));
+        const BSONObj selector = BSON("_id" << 1);
+        while (state.keepRunning())
+            fixture.conn().remove(kNamespace, selector, true, &WriteConcern::acknowledged);
+    }
+
+    MONGO_BENCHMARK(CursorIterate10000) {
+        LoopbackFixture fixture(serverOptions(benchmark::documentOfShape(benchmark::kSmallFlat),
+                                              10000));
+        while (state.keepRunning())
+            iterateAll(fixture.conn(), false);
+    }
+
+    MONGO_BENCHMARK(CursorIterate10000Prefetch) {
+        LoopbackFixture fixture(serverOptions(benchmark::documentOfShape(benchmark::kSmallFlat),
+                                              10000));
+        while (state.keepRunning())
+            iterateAll(fixture.conn(), true);
+    }
+
+    MONGO_BENCHMARK(BulkInsertUnordered1000) {
+        LoopbackFixture fixture(serverOptions(BSONObj(), 1));
+        const std::vector<BSONObj> docs(1000, benchmark::documentOfShape(benchmark::kSmallFlat));
+        while (state.keepRunning())
+            bulkInsert(fixture.conn(), docs);
+    }
+
+    MONGO_BENCHMARK(BulkInsertUnordered1000Legacy) {
+        // Before wire version 2 the driver sends OP_INSERT followed by getLastError.
+        LoopbackServer::Options options = serverOptions(BSONObj(), 1);
+        options.maxWireVersion = 0;
+
+        LoopbackFixture fixture(options);
+        const std::vector<BSONObj> docs(1000, benchmark::documentOfShape(benchmark::kSmallFlat));
+        while (state.keepRunning())
+            bulkInsert(fixture.conn(), docs);
+    }
+
+    MONGO_BENCHMARK(BulkInsertUnordered10000) {
+        LoopbackFixture fixture(serverOptions(BSONObj(), 1));
+        const std::vector<BSONObj> docs(10000, benchmark::documentOfShape(benchmark::kSmallFlat));
+        while (state.keepRunning())
+            bulkInsert(fixture.conn(), docs);
+    }
+
+    MONGO_BENCHMARK(BulkInsertStreaming10000) {
+        LoopbackFixture fixture(serverOptions(BSONObj(), 1));
+        const std::vector<BSONObj> docs(10000, benchmark::documentOfShape(benchmark::kSmallFlat));
+        while (state.keepRunning())
+            streamingInsert(fixture.conn(), docs);
+    }
+
+    MONGO_BENCHMARK(BulkInsertParallel10000) {
+        LoopbackFixture fixture(serverOptions(BSONObj(), 1));
+        std::vector<DBClientBase*> extraConns;
+        for (int i = 0; i < 3; ++i)
+            extraConns.push_back(fixture.openConnection());
+
+        const std::vector<BSONObj> docs(10000, benchmark::documentOfShape(benchmark::kSmallFlat));
+        while (state.keepRunning())
+            parallelInsert(fixture.conn(), docs, extraConns);
+    }
+
+} // namespace
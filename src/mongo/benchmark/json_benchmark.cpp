@@ -0,0 +1,51 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+
+#include "mongo/benchmark/benchmark.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+
+namespace {
+
+    using namespace mongo;
+
+    MONGO_BENCHMARK_EACH_SHAPE(FromJson) {
+        const std::string json = doc.jsonString();
+        while (state.keepRunning()) {
+            BSONObj obj = fromjson(json);
+            benchmark::doNotOptimizeAway(obj.objdata());
+        }
+    }
+
+    MONGO_BENCHMARK_EACH_SHAPE(JsonStringStrict) {
+        while (state.keepRunning()) {
+            std::string json = doc.jsonString(Strict);
+            benchmark::doNotOptimizeAway(json.data());
+        }
+    }
+
+    MONGO_BENCHMARK_EACH_SHAPE(JsonStringTenGen) {
+        while (state.keepRunning()) {
+            std::string json = doc.jsonString(TenGen);
+            benchmark::doNotOptimizeAway(json.data());
+        }
+    }
+
+} // namespace
@@ -0,0 +1,332 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/benchmark/loopback_server.h"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
+#include <cstdlib>
+#include <map>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "mongo/client/constants.h"
+#include "mongo/db/dbmessage.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/message_port.h"
+#include "mongo/util/net/sock.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace benchmark {
+
+namespace {
+
+    // mongod's batch limits: the first batch of a query without a batch size holds at most 101
+    // documents and 1MB, and no batch holds more than 4MB unless one document is larger.
+    const int kDefaultFirstBatchSize = 101;
+    const int kMaxFirstBatchBytes = 1024 * 1024;
+    const int kMaxBatchBytes = 4 * 1024 * 1024;
+
+    // Result sets left open on one connection, by cursor id, with how many documents each
+    // has returned so far.
+    typedef std::map<long long, int> CursorMap;
+
+    bool isCommandNamespace(const StringData& ns) {
+        return ns.endsWith(".$cmd");
+    }
+
+    BSONObj runCommand(const BSONObj& query, int maxWireVersion) {
+        BSONObj cmd = query;
+        if (cmd.hasField("$query"))
+            cmd = cmd["$query"].Obj();
+        else if (cmd.hasField("query") && cmd.firstElementFieldName() == StringData("query"))
+            cmd = cmd["query"].Obj();
+
+        const std::string name = cmd.firstElementFieldName();
+        BSONObjBuilder reply;
+
+        if (name == "ismaster" || name == "isMaster") {
+            reply.append("ismaster", true);
+            reply.append("maxBsonObjectSize", BSONObjMaxUserSize);
+            reply.append("maxMessageSizeBytes", static_cast<int>(MaxMessageSizeBytes));
+            reply.append("maxWriteBatchSize", 1000);
+            reply.appendDate("localTime", jsTime());
+            reply.append("maxWireVersion", maxWireVersion);
+            reply.append("minWireVersion", 0);
+        }
+        else if (name == "getlasterror" || name == "getLastError") {
+            reply.append("n", 0);
+            reply.appendNull("err");
+        }
+        else if (name == "insert") {
+            reply.append("n", cmd["documents"].Obj().nFields());
+        }
+        else if (name == "update") {
+            const int n = cmd["updates"].Obj().nFields();
+            reply.append("n", n);
+            reply.append("nModified", n);
+        }
+        else if (name == "delete") {
+            reply.append("n", cmd["deletes"].Obj().nFields());
+        }
+
+        reply.append("ok", 1.0);
+        return reply.obj();
+    }
+
+    void replyWithCommandResult(MessagingPort* port, Message& request, const BSONObj& result) {
+        replyToQuery(0, port, request, const_cast<char*>(result.objdata()), result.objsize(), 1);
+    }
+
+} // namespace
+
+    LoopbackServer::Options::Options()
+        : numDocuments(1)
+        , maxWireVersion(2)
+    {}
+
+    LoopbackServer::LoopbackServer(const Options& options)
+        : _options(options)
+        , _listenSocket(-1)
+        , _shutdown(false)
+    {
+        const int documentSize = _options.document.objsize();
+        _maxBatchSize = std::max(1, std::min(_options.numDocuments,
+                                             kMaxBatchBytes / documentSize));
+        _documents.reserve(_maxBatchSize * documentSize);
+        for (int i = 0; i < _maxBatchSize; ++i)
+            _documents.append(_options.document.objdata(), documentSize);
+
+        const bool useUnixSocket = !_options.unixSocketPath.empty();
+        SockAddr address(useUnixSocket ? _options.unixSocketPath.c_str() : "127.0.0.1", 0);
+        if (useUnixSocket)
+            ::unlink(_options.unixSocketPath.c_str());
+
+        _listenSocket = ::socket(address.getType(), SOCK_STREAM, 0);
+        uassert(0, str::stream() << "could not create listening socket: "
+                                 << errnoWithDescription(),
+                _listenSocket >= 0);
+
+        if (!useUnixSocket) {
+            const int on = 1;
+            ::setsockopt(_listenSocket, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+        }
+
+        if (::bind(_listenSocket, address.raw(), address.addressSize) != 0 ||
+            ::listen(_listenSocket, 128) != 0) {
+            const std::string error = errnoWithDescription();
+            ::close(_listenSocket);
+            uasserted(0, str::stream() << "could not listen on " << address.toString() << ": "
+                                       << error);
+        }
+
+        if (useUnixSocket) {
+            _hostAndPort = HostAndPort(_options.unixSocketPath);
+        }
+        else {
+            sockaddr_in bound;
+            socklen_t boundSize = sizeof(bound);
+            ::getsockname(_listenSocket, reinterpret_cast<sockaddr*>(&bound), &boundSize);
+            _hostAndPort = HostAndPort("127.0.0.1", ntohs(bound.sin_port));
+        }
+
+        _acceptThread = boost::thread(boost::bind(&LoopbackServer::_acceptConnections, this));
+    }
+
+    LoopbackServer::~LoopbackServer() {
+        shutdown();
+    }
+
+    HostAndPort LoopbackServer::getServerHostAndPort() const {
+        return _hostAndPort;
+    }
+
+    void LoopbackServer::shutdown() {
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            if (_shutdown)
+                return;
+            _shutdown = true;
+
+            for (std::set<boost::shared_ptr<MessagingPort> >::const_iterator it = _ports.begin();
+                 it != _ports.end(); ++it) {
+                (*it)->shutdown();
+            }
+        }
+
+        // Wakes the accept thread.
+        ::shutdown(_listenSocket, SHUT_RDWR);
+        _acceptThread.join();
+        ::close(_listenSocket);
+        if (!_options.unixSocketPath.empty())
+            ::unlink(_options.unixSocketPath.c_str());
+
+        _connectionThreads.join_all();
+    }
+
+    unsigned long long LoopbackServer::getNumRequests() const {
+        return _numRequests.load();
+    }
+
+    void LoopbackServer::_acceptConnections() {
+        while (true) {
+            SockAddr remote;
+            const int fd = ::accept(_listenSocket, remote.raw(), &remote.addressSize);
+
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            if (_shutdown) {
+                if (fd >= 0)
+                    ::close(fd);
+                return;
+            }
+
+            if (fd < 0) {
+                warning() << "loopback server accept failed: " << errnoWithDescription();
+                continue;
+            }
+
+            if (remote.getType() != AF_UNIX)
+                disableNagle(fd);
+
+            boost::shared_ptr<MessagingPort> port(new MessagingPort(fd, remote));
+            port->psock->setHandshakeReceived();
+            _ports.insert(port);
+            _connectionThreads.create_thread(
+                boost::bind(&LoopbackServer::_serveConnection, this, port));
+        }
+    }
+
+    void LoopbackServer::_serveConnection(boost::shared_ptr<MessagingPort> port) {
+        CursorMap cursors;
+        long long nextCursorId = 1;
+        const int documentSize = _options.document.objsize();
+
+        try {
+            Message request;
+            while (port->recv(request)) {
+                _numRequests.fetchAndAdd(1);
+
+                const int op = request.operation();
+                DbMessage d(request);
+
+                int resultFlags = ResultFlag_AwaitCapable;
+                int startingFrom = 0;
+                int available = 0;
+                int requested = 0;
+                bool singleBatch = false;
+                long long cursorId = 0;
+
+                if (op == dbQuery) {
+                    QueryMessage q(d);
+                    if (isCommandNamespace(q.ns)) {
+                        replyWithCommandResult(port.get(), request,
+                                               runCommand(q.query, _options.maxWireVersion));
+                        request.reset();
+                        continue;
+                    }
+
+                    available = _options.numDocuments;
+
+                    // A negative count, or one, asks for a single batch and no cursor.
+                    requested = std::abs(q.ntoreturn);
+                    singleBatch = q.ntoreturn < 0 || q.ntoreturn == 1;
+                    if (requested == 0)
+                        requested = std::min(kDefaultFirstBatchSize,
+                                             std::max(1, kMaxFirstBatchBytes / documentSize));
+                }
+                else if (op == dbGetMore) {
+                    const int ntoreturn = d.pullInt();
+                    requested = std::abs(ntoreturn);
+                    singleBatch = ntoreturn < 0;
+                    if (requested == 0)
+                        requested = _maxBatchSize;
+                    cursorId = d.pullInt64();
+
+                    CursorMap::iterator it = cursors.find(cursorId);
+                    if (it == cursors.end()) {
+                        resultFlags = ResultFlag_CursorNotFound;
+                        cursorId = 0;
+                    }
+                    else {
+                        startingFrom = it->second;
+                        available = _options.numDocuments - startingFrom;
+                        cursors.erase(it);
+                    }
+                }
+                else if (op == dbKillCursors) {
+                    const int n = d.pullInt();
+                    for (int i = 0; i < n; ++i)
+                        cursors.erase(d.pullInt64());
+                    request.reset();
+                    continue;
+                }
+                else {
+                    // Legacy writes get no reply.
+                    request.reset();
+                    continue;
+                }
+
+                const int n = std::min(available, std::min(requested, _maxBatchSize));
+
+                if (!singleBatch && startingFrom + n < _options.numDocuments) {
+                    if (cursorId == 0)
+                        cursorId = nextCursorId++;
+                    cursors[cursorId] = startingFrom + n;
+                }
+                else {
+                    cursorId = 0;
+                }
+
+                // The documents go out in place, after a header built for this reply.
+                BufBuilder b;
+                b.skip(sizeof(QueryResult::Value));
+                QueryResult::View qr = b.buf();
+                qr.setResultFlags(resultFlags);
+                qr.msgdata().setLen(b.len());
+                qr.msgdata().setOperation(opReply);
+                qr.setCursorId(cursorId);
+                qr.setStartingFrom(startingFrom);
+                qr.setNReturned(n);
+
+                Message response;
+                response.appendData(b.buf(), b.len());
+                b.decouple();
+                response.appendBorrowedData(_documents.data(), n * documentSize);
+                port->reply(request, response, request.header().getId());
+
+                request.reset();
+            }
+        }
+        catch (const std::exception& e) {
+            warning() << "loopback server closing connection after error: " << e.what();
+        }
+
+        port->shutdown();
+
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        _ports.erase(port);
+    }
+
+} // namespace benchmark
+} // namespace mongo
@@ -0,0 +1,106 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <set>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/net/message.h"
+
+namespace mongo {
+
+    class MessagingPort;
+
+namespace benchmark {
+
+    /**
+     * A fake server that speaks the wire protocol over real loopback TCP or Unix domain
+     * sockets, so that the driver's networking path can be measured without a database.
+     *
+     * Every query returns the same canned result set: Options::numDocuments copies of
+     * Options::document, in batches sized the way mongod sizes them, with getMore and
+     * killCursors supported. Commands get a canned success reply; isMaster describes a
+     * standalone with the configured wire version, and write commands report every document
+     * as written. Legacy writes are accepted and discarded.
+     *
+     * Each connection is served on its own thread. The server only exists to be talked to by
+     * the driver, so requests it cannot parse just close the connection.
+     */
+    class LoopbackServer {
+        MONGO_DISALLOW_COPYING(LoopbackServer);
+    public:
+        struct Options {
+            Options();
+
+            // Listen on this Unix domain socket instead of on an ephemeral 127.0.0.1 port.
+            std::string unixSocketPath;
+
+            // The document every query returns, and how many copies of it.
+            BSONObj document;
+            int numDocuments;
+
+            // Reported by isMaster. The driver uses write commands from version 2.
+            int maxWireVersion;
+        };
+
+        /** Starts listening. Throws if the socket cannot be bound. */
+        explicit LoopbackServer(const Options& options);
+
+        ~LoopbackServer();
+
+        /** @return the address to connect the driver to. */
+        HostAndPort getServerHostAndPort() const;
+
+        /** Closes the listening socket and every connection, and waits for their threads. */
+        void shutdown();
+
+        /** @return the number of requests received on all connections so far. */
+        unsigned long long getNumRequests() const;
+
+    private:
+        void _acceptConnections();
+        void _serveConnection(boost::shared_ptr<MessagingPort> port);
+
+        const Options _options;
+
+        // Batches are sent straight out of this buffer, which holds as many back-to-back
+        // copies of the document as fit in the largest batch.
+        std::string _documents;
+        int _maxBatchSize;
+
+        HostAndPort _hostAndPort;
+        int _listenSocket;
+
+        AtomicUInt64 _numRequests;
+
+        // Guards _ports and _shutdown.
+        boost::mutex _mutex;
+        std::set<boost::shared_ptr<MessagingPort> > _ports;
+        bool _shutdown;
+
+        boost::thread_group _connectionThreads;
+        boost::thread _acceptThread;
+    };
+
+} // namespace benchmark
+} // namespace mongo
@@ -0,0 +1,62 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/benchmark/benchmark.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/net/message.h"
+
+namespace {
+
+    using namespace mongo;
+
+    const char kNamespace[] = "benchmark.collection";
+
+    // An OP_INSERT assembled the way DBClientBase::insert does it: the document is copied into
+    // the body, which setData then copies again behind the header.
+    MONGO_BENCHMARK_EACH_SHAPE(MessageInsertCopied) {
+        while (state.keepRunning()) {
+            BufBuilder b;
+            b.appendNum(0);
+            b.appendStr(kNamespace);
+            doc.appendSelfToBufBuilder(b);
+
+            Message toSend;
+            toSend.setData(dbInsert, b.buf(), b.len());
+            benchmark::doNotOptimizeAway(toSend.singleData().view2ptr());
+        }
+    }
+
+    // An OP_INSERT assembled the way WireProtocolWriter does it for large documents: the
+    // header and preamble in one buffer, with the document sent in place.
+    MONGO_BENCHMARK_EACH_SHAPE(MessageInsertBorrowed) {
+        while (state.keepRunning()) {
+            BufBuilder b;
+            b.skip(MsgData::MsgDataHeaderSize);
+            b.appendNum(0);
+            b.appendStr(kNamespace);
+
+            Message toSend;
+            toSend.appendData(b.buf(), b.len());
+            b.decouple();
+            toSend.appendBorrowedData(doc.objdata(), doc.objsize());
+            toSend.header().setOperation(dbInsert);
+            benchmark::doNotOptimizeAway(&toSend);
+        }
+    }
+
+} // namespace
@@ -0,0 +1,49 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/benchmark/benchmark.h"
+#include "mongo/bson/oid.h"
+
+namespace {
+
+    using namespace mongo;
+
+    MONGO_BENCHMARK(OIDGen) {
+        while (state.keepRunning()) {
+            OID oid = OID::gen();
+            benchmark::doNotOptimizeAway(&oid);
+        }
+    }
+
+    MONGO_BENCHMARK(OIDGenMany100) {
+        OID oids[100];
+        while (state.keepRunning()) {
+            OID::genMany(oids, 100);
+            benchmark::doNotOptimizeAway(oids);
+        }
+    }
+
+    MONGO_BENCHMARK(OIDToString) {
+        const OID oid = OID::gen();
+        while (state.keepRunning()) {
+            std::string str = oid.toString();
+            benchmark::doNotOptimizeAway(str.data());
+        }
+    }
+
+} // namespace
@@ -0,0 +1,76 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bson_field_index.h"
+
+#include "mongo/bson/bsonobjiterator.h"
+
+namespace mongo {
+
+    BSONObjFieldIndex::BSONObjFieldIndex(const BSONObj& obj)
+        : _obj(obj)
+        , _nFields(0)
+        , _mask(0)
+    {
+        std::vector<BSONElement> elements;
+        BSONObjIterator it(_obj);
+        while (it.more())
+            elements.push_back(it.next());
+        _nFields = elements.size();
+
+        size_t numSlots = 8;
+        while (numSlots < elements.size() * 2)
+            numSlots *= 2;
+        _slots.assign(numSlots, NULL);
+        _mask = numSlots - 1;
+
+        const StringData::Hasher hasher;
+        for (size_t i = 0; i < elements.size(); ++i) {
+            const StringData name = elements[i].fieldNameStringData();
+
+            size_t slot = hasher(name) & _mask;
+            while (_slots[slot] && BSONElement(_slots[slot]).fieldNameStringData() != name)
+                slot = (slot + 1) & _mask;
+
+            // Keep the first of several fields with the same name, as getField does.
+            if (!_slots[slot])
+                _slots[slot] = elements[i].rawdata();
+        }
+    }
+
+    BSONElement BSONObjFieldIndex::getField(const StringData& name) const {
+        size_t slot = StringData::Hasher()(name) & _mask;
+        while (_slots[slot]) {
+            const BSONElement e(_slots[slot]);
+            if (e.fieldNameStringData() == name)
+                return e;
+            slot = (slot + 1) & _mask;
+        }
+        return BSONElement();
+    }
+
+    void BSONObjFieldIndex::getFields(unsigned n, const char** fieldNames,
+                                      BSONElement* fields) const {
+        for (unsigned i = 0; i < n; ++i) {
+            const BSONElement e = getField(fieldNames[i]);
+            if (!e.eoo())
+                fields[i] = e;
+        }
+    }
+
+} // namespace mongo
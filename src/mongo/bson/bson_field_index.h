@@ -0,0 +1,79 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/client/export_macros.h"
+
+namespace mongo {
+
+    /**
+     * An index of the top-level fields of a BSONObj, for reading many fields from the same
+     * object.
+     *
+     * BSONObj::getField walks the object from the start on every call, so reading k fields
+     * from an object of n fields costs O(n * k). Building a BSONObjFieldIndex walks the object
+     * once; after that each lookup is a hash probe. It only pays off for objects with more than
+     * a handful of fields that are read more than a few times:
+     *
+     *     BSONObjFieldIndex fields(doc);
+     *     const int age = fields["age"].numberInt();
+     *     const std::string name = fields["name"].String();
+     *
+     * Lookups give the same results as BSONObj::getField, including returning the first of
+     * several fields with the same name. The index keeps a copy of the BSONObj, so for an
+     * owned object it stays valid however long the original BSONObj lives. An unowned object,
+     * such as one in a cursor's batch, does not keep its buffer alive; the buffer must then
+     * outlive the index, or the index be built from obj.getOwned(). The index is not modified
+     * by lookups and so may be shared between threads.
+     */
+    class MONGO_CLIENT_API BSONObjFieldIndex {
+    public:
+        explicit BSONObjFieldIndex(const BSONObj& obj);
+
+        /** @return the field of the given name, or an eoo() element if there is none. */
+        BSONElement getField(const StringData& name) const;
+
+        BSONElement operator[](const StringData& name) const {
+            return getField(name);
+        }
+
+        /**
+         * Looks up several fields at once, with the same contract as BSONObj::getFields: if
+         * fieldNames[i] is found it is stored in fields[i], which is otherwise left unchanged.
+         */
+        void getFields(unsigned n, const char** fieldNames, BSONElement* fields) const;
+
+        /** @return the number of top-level fields in the object. */
+        int nFields() const { return _nFields; }
+
+        const BSONObj& obj() const { return _obj; }
+
+    private:
+        BSONObj _obj;
+        int _nFields;
+
+        // Open-addressed hash table of pointers to the start of each element, or NULL for an
+        // empty slot. Its size is a power of two at least twice the number of fields.
+        std::vector<const char*> _slots;
+        size_t _mask;
+    };
+
+} // namespace mongo
@@ -0,0 +1,130 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bson_field_index.h"
+
+#include <string>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace {
+
+    using mongo::BSONElement;
+    using mongo::BSONObj;
+    using mongo::BSONObjBuilder;
+    using mongo::BSONObjFieldIndex;
+
+    BSONObj wideObject(int nFields) {
+        BSONObjBuilder b;
+        for (int i = 0; i < nFields; ++i)
+            b.append(std::string(mongo::str::stream() << "field" << i), i);
+        return b.obj();
+    }
+
+    TEST(BSONObjFieldIndex, FindsEveryField) {
+        const BSONObj obj = wideObject(300);
+        const BSONObjFieldIndex index(obj);
+        ASSERT_EQUALS(300, index.nFields());
+
+        for (int i = 0; i < 300; ++i) {
+            const std::string name = mongo::str::stream() << "field" << i;
+            ASSERT_EQUALS(i, index[name].numberInt());
+            ASSERT_EQUALS(obj[name].rawdata(), index[name].rawdata());
+        }
+    }
+
+    TEST(BSONObjFieldIndex, MissingFieldIsEOO) {
+        const BSONObjFieldIndex index(BSON("a" << 1 << "b" << 2));
+        ASSERT_TRUE(index["c"].eoo());
+        ASSERT_TRUE(index[""].eoo());
+        ASSERT_TRUE(index["ab"].eoo());
+    }
+
+    TEST(BSONObjFieldIndex, EmptyObject) {
+        const BSONObjFieldIndex index((BSONObj()));
+        ASSERT_EQUALS(0, index.nFields());
+        ASSERT_TRUE(index["a"].eoo());
+    }
+
+    TEST(BSONObjFieldIndex, DuplicateNamesReturnFirst) {
+        const BSONObj obj = BSON("a" << 1 << "b" << 2 << "a" << 3);
+        const BSONObjFieldIndex index(obj);
+        ASSERT_EQUALS(1, index["a"].numberInt());
+        ASSERT_EQUALS(obj["a"].rawdata(), index["a"].rawdata());
+    }
+
+    TEST(BSONObjFieldIndex, OutlivesOriginalObject) {
+        BSONObj obj = wideObject(20);
+        const BSONObjFieldIndex index(obj);
+        obj = BSONObj();
+        ASSERT_EQUALS(19, index["field19"].numberInt());
+    }
+
+    TEST(BSONObjFieldIndex, GetFieldsLeavesMissingUnchanged) {
+        const BSONObj obj = wideObject(50);
+        const BSONObjFieldIndex index(obj);
+        const BSONObj placeholder = BSON("missing" << true);
+
+        const char* names[] = { "field42", "nope", "field0" };
+        BSONElement fields[3];
+        fields[1] = placeholder.firstElement();
+        index.getFields(3, names, fields);
+
+        ASSERT_EQUALS(42, fields[0].numberInt());
+        ASSERT_EQUALS(placeholder.firstElement().rawdata(), fields[1].rawdata());
+        ASSERT_EQUALS(0, fields[2].numberInt());
+    }
+
+    TEST(BSONObjGetFields, FindsRequestedFields) {
+        const BSONObj obj = wideObject(50);
+        const char* names[] = { "field49", "field3", "nope" };
+        BSONElement fields[3];
+        obj.getFields(3, names, fields);
+
+        ASSERT_EQUALS(49, fields[0].numberInt());
+        ASSERT_EQUALS(3, fields[1].numberInt());
+        ASSERT_TRUE(fields[2].eoo());
+    }
+
+    TEST(BSONObjGetFields, DuplicateNamesReturnFirst) {
+        const BSONObj obj = BSON("a" << 1 << "a" << 2);
+        const char* names[] = { "a" };
+        BSONElement fields[1];
+        obj.getFields(1, names, fields);
+        ASSERT_EQUALS(1, fields[0].numberInt());
+    }
+
+    TEST(BSONObjGetFields, ManyNames) {
+        const BSONObj obj = wideObject(100);
+        std::vector<std::string> nameStrings;
+        for (int i = 99; i >= 0; --i)
+            nameStrings.push_back(mongo::str::stream() << "field" << i);
+
+        std::vector<const char*> names;
+        for (size_t i = 0; i < nameStrings.size(); ++i)
+            names.push_back(nameStrings[i].c_str());
+
+        std::vector<BSONElement> fields(names.size());
+        obj.getFields(names.size(), &names[0], &fields[0]);
+        for (int i = 0; i < 100; ++i)
+            ASSERT_EQUALS(99 - i, fields[i].numberInt());
+    }
+
+} // namespace
@@ -36,15 +36,26 @@ namespace mongo {
 
     // need to move to bson/, but has dependency on base64 so move that to bson/util/ first.
     string BSONElement::jsonString( JsonStringFormat format, bool includeFieldNames, int pretty ) const {
+        StringBuilder s;
+        jsonStringStream( format, includeFieldNames, pretty, s );
+        return s.str();
+    }
+
+    void BSONElement::jsonStringStream( JsonStringFormat format, bool includeFieldNames, int pretty,
+                                        StringBuilder& s ) const {
         int sign;
 
-        stringstream s;
-        if ( includeFieldNames )
-            s << '"' << escape( fieldName() ) << "\" : ";
+        if ( includeFieldNames ) {
+            s << '"';
+            escape( s, StringData( fieldName(), fieldNameSize() - 1 ) );
+            s << "\" : ";
+        }
         switch ( type() ) {
         case mongo::String:
         case Symbol:
-            s << '"' << escape( string(valuestr(), valuestrsize()-1) ) << '"';
+            s << '"';
+            escape( s, StringData( valuestr(), valuestrsize() - 1 ) );
+            s << '"';
             break;
         case NumberLong:
             if (format == TenGen) {
@@ -62,8 +73,7 @@ namespace mongo {
         case NumberDouble:
             if ( number() >= -numeric_limits< double >::max() &&
                     number() <= numeric_limits< double >::max() ) {
-                s.precision( 16 );
-                s << number();
+                s.appendDoublePrecise( number() );
             }
             // This is not valid JSON, but according to RFC-4627, "Numeric values that cannot be
             // represented as sequences of digits (such as Infinity and NaN) are not permitted." so
@@ -96,7 +106,7 @@ namespace mongo {
             }
             break;
         case Object:
-            s << embeddedObject().jsonString( format, pretty );
+            embeddedObject().jsonStringStream( format, pretty, false, s );
             break;
         case mongo::Array: {
             if ( embeddedObject().isEmpty() ) {
@@ -119,7 +129,7 @@ namespace mongo {
                         s << "undefined";
                     }
                     else {
-                        s << e.jsonString( format, false, pretty?pretty+1:0 );
+                        e.jsonStringStream( format, false, pretty?pretty+1:0, s );
                         e = i.next();
                     }
                     count++;
@@ -166,13 +176,12 @@ namespace mongo {
             const int len = reader.readLEAndAdvance<int>();
             BinDataType type = static_cast<BinDataType>(reader.readLEAndAdvance<uint8_t>());
 
+            static const char hexDigits[] = "0123456789abcdef";
             s << "{ \"$binary\" : \"";
             base64::encode( s , reader.view() , len );
-            s << "\", \"$type\" : \"" << hex;
-            s.width( 2 );
-            s.fill( '0' );
-            s << type << dec;
-            s << "\" }";
+            s << "\", \"$type\" : \""
+              << hexDigits[(type >> 4) & 0xf] << hexDigits[type & 0xf]
+              << "\" }";
             break;
         }
         case mongo::Date:
@@ -220,11 +229,14 @@ namespace mongo {
             break;
         case RegEx:
             if ( format == Strict ) {
-                s << "{ \"$regex\" : \"" << escape( regex() );
+                s << "{ \"$regex\" : \"";
+                escape( s, regex() );
                 s << "\", \"$options\" : \"" << regexFlags() << "\" }";
             }
             else {
-                s << "/" << escape( regex() , true ) << "/";
+                s << "/";
+                escape( s, regex(), true );
+                s << "/";
                 // FIXME Worry about alpha order?
                 for ( const char *f = regexFlags(); *f; ++f ) {
                     switch ( *f ) {
@@ -242,14 +254,22 @@ namespace mongo {
         case CodeWScope: {
             BSONObj scope = codeWScopeObject();
             if ( ! scope.isEmpty() ) {
-                s << "{ \"$code\" : \"" << escape(_asCode()) << "\" , "
-                  << "\"$scope\" : " << scope.jsonString() << " }";
+                s << "{ \"$code\" : \"";
+                escape( s, StringData( codeWScopeCode(), codeWScopeCodeLen() - 1 ) );
+                s << "\" , \"$scope\" : ";
+                scope.jsonStringStream( Strict, 0, false, s );
+                s << " }";
                 break;
             }
         }
 
         case Code:
-            s << "\"" << escape(_asCode()) << "\"";
+            // A CodeWScope with an empty scope falls through to here.
+            s << "\"";
+            escape( s, type() == CodeWScope ?
+                    StringData( codeWScopeCode(), codeWScopeCodeLen() - 1 ) :
+                    StringData( valuestr(), valuestrsize() - 1 ) );
+            s << "\"";
             break;
 
         case mongo::Timestamp: {
@@ -277,7 +297,6 @@ namespace mongo {
             string message = ss.str();
             massert( 10312 ,  message.c_str(), false );
         }
-        return s.str();
     }
 
     int BSONElement::getGtLtOp( int def ) const {
@@ -766,46 +785,55 @@ namespace mongo {
         return true;
     }
 
+namespace {
+    // For each byte, the character that follows the backslash when escaping it for JSON, 'u'
+    // for bytes written as \u00XX, or 0 for bytes copied as is. '/' is only escaped on request.
+    // A constant table rather than one built at startup, so jsonString() works from static
+    // initializers.
+    const char jsonEscapeTable[256] = {
+        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+        'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+        0, 0, '"', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '/',
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, '\\', 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        // 0x80 - 0xff are all copied as is.
+    };
+} // namespace
+
     // used by jsonString()
-    std::string escape( const std::string& s , bool escape_slash) {
-        StringBuilder ret;
-        for ( std::string::const_iterator i = s.begin(); i != s.end(); ++i ) {
-            switch ( *i ) {
-            case '"':
-                ret << "\\\"";
-                break;
-            case '\\':
-                ret << "\\\\";
-                break;
-            case '/':
-                ret << (escape_slash ? "\\/" : "/");
-                break;
-            case '\b':
-                ret << "\\b";
-                break;
-            case '\f':
-                ret << "\\f";
-                break;
-            case '\n':
-                ret << "\\n";
-                break;
-            case '\r':
-                ret << "\\r";
-                break;
-            case '\t':
-                ret << "\\t";
-                break;
-            default:
-                if ( *i >= 0 && *i <= 0x1f ) {
-                    //TODO: these should be utf16 code-units not bytes
-                    char c = *i;
-                    ret << "\\u00" << toHexLower(&c, 1);
-                }
-                else {
-                    ret << *i;
-                }
+    void escape( StringBuilder& out , const StringData& s , bool escape_slash ) {
+        static const char hexDigits[] = "0123456789abcdef";
+        const char* const end = s.rawData() + s.size();
+        const char* run = s.rawData();
+
+        // Copy runs of bytes that need no escaping in one go.
+        for ( const char* p = run; p != end; ++p ) {
+            const unsigned char c = static_cast<unsigned char>( *p );
+            const char escaped = jsonEscapeTable[c];
+            if ( !escaped || ( escaped == '/' && !escape_slash ) )
+                continue;
+
+            out.write( run, p - run );
+            run = p + 1;
+
+            out << '\\';
+            if ( escaped == 'u' ) {
+                //TODO: these should be utf16 code-units not bytes
+                out << "u00" << hexDigits[c >> 4] << hexDigits[c & 0xf];
+            }
+            else {
+                out << escaped;
             }
         }
+        out.write( run, end - run );
+    }
+
+    std::string escape( const std::string& s , bool escape_slash) {
+        StringBuilder ret;
+        escape( ret, s, escape_slash );
         return ret.str();
     }
 
@@ -107,6 +107,9 @@ namespace mongo {
         std::string toString( bool includeFieldName = true, bool full=false) const;
         void toString(StringBuilder& s, bool includeFieldName = true, bool full=false, int depth=0) const;
         std::string jsonString( JsonStringFormat format, bool includeFieldNames = true, int pretty = 0 ) const;
+        /** Appends what jsonString() would return to 's', without intermediate strings. */
+        void jsonStringStream( JsonStringFormat format, bool includeFieldNames, int pretty,
+                               StringBuilder& s ) const;
         operator std::string() const { return toString(); }
 
         /** Returns the type of the element */
@@ -639,5 +642,6 @@ namespace mongo {
 
     // TODO(SERVER-14596): move to a better place; take a StringData.
     std::string escape( const std::string& s , bool escape_slash=false);
+    void escape( StringBuilder& out , const StringData& s , bool escape_slash=false );
 
 }
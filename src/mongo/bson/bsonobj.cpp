@@ -73,16 +73,24 @@ namespace mongo {
     }
 
     string BSONObj::jsonString( JsonStringFormat format, int pretty, bool isArray ) const {
+        StringBuilder s;
+        jsonStringStream( format, pretty, isArray, s );
+        return s.str();
+    }
 
-        if ( isEmpty() ) return isArray ? "[]" : "{}";
+    void BSONObj::jsonStringStream( JsonStringFormat format, int pretty, bool isArray,
+                                    StringBuilder& s ) const {
+        if ( isEmpty() ) {
+            s << (isArray ? "[]" : "{}");
+            return;
+        }
 
-        StringBuilder s;
         s << (isArray ?  "[ " : "{ ");
         BSONObjIterator i(*this);
         BSONElement e = i.next();
         if ( !e.eoo() )
             while ( 1 ) {
-                s << e.jsonString( format, !isArray, pretty?pretty+1:0 );
+                e.jsonStringStream( format, !isArray, pretty?pretty+1:0, s );
                 e = i.next();
                 if ( e.eoo() )
                     break;
@@ -97,7 +105,6 @@ namespace mongo {
                 }
             }
         s << (isArray ? " ]" : " }");
-        return s.str();
     }
 
     bool BSONObj::valid() const {
@@ -615,13 +622,29 @@ namespace mongo {
     }
 
     void BSONObj::getFields(unsigned n, const char **fieldNames, BSONElement *fields) const { 
+        // Which names have been found, so that the scan can stop once all of them have been and
+        // so that the first of several fields with the same name wins, as with getField().
+        char stackFound[32];
+        std::vector<char> heapFound;
+        char* found = stackFound;
+        if ( n > sizeof(stackFound) ) {
+            heapFound.assign(n, 0);
+            found = &heapFound[0];
+        }
+        else {
+            memset(stackFound, 0, sizeof(stackFound));
+        }
+        unsigned numFound = 0;
+
         BSONObjIterator i(*this);
-        while ( i.more() ) {
+        while ( i.more() && numFound < n ) {
             BSONElement e = i.next();
-            const char *p = e.fieldName();
-            for( unsigned i = 0; i < n; i++ ) {
-                if( strcmp(p, fieldNames[i]) == 0 ) {
-                    fields[i] = e;
+            const char* name = e.fieldName();
+            for( unsigned j = 0; j < n; j++ ) {
+                if( !found[j] && strcmp(name, fieldNames[j]) == 0 ) {
+                    fields[j] = e;
+                    found[j] = true;
+                    numFound++;
                     break;
                 }
             }
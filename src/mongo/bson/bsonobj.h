@@ -185,6 +185,10 @@ namespace mongo {
             bool isArray = false
         ) const;
 
+        /** Appends what jsonString() would return to 's', in a single pass over the object. */
+        void jsonStringStream( JsonStringFormat format, int pretty, bool isArray,
+                               StringBuilder& s ) const;
+
         /** note: addFields always adds _id even if not specified */
         int addFields(BSONObj& from, std::set<std::string>& fields); /* returns n added */
 
@@ -225,7 +229,9 @@ namespace mongo {
         BSONElement getField(const StringData& name) const;
 
         /** Get several fields at once. This is faster than separate getField() calls as the size of
-            elements iterated can then be calculated only once each.
+            elements iterated can then be calculated only once each, and the scan stops as soon as
+            every name has been found. To read many fields from a wide object repeatedly, build a
+            BSONObjFieldIndex instead.
             @param n number of fieldNames, and number of elements in the fields array
             @param fields if a field is found its element is stored in its corresponding position in this array.
                    if not found the array element is unchanged.
@@ -19,13 +19,16 @@
 
 #include "mongo/bson/oid.h"
 
+#include <algorithm>
 #include <boost/functional/hash.hpp>
 #include <boost/scoped_ptr.hpp>
+#include <ctime>
 
 #include "mongo/base/init.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/random.h"
+#include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/hex.h"
 
 namespace mongo {
@@ -39,6 +42,55 @@ namespace {
     const std::size_t kIncrementOffset = kInstanceUniqueOffset +
                                          OID::kInstanceUniqueSize;
     OID::InstanceUnique _instanceUnique;
+
+    // Each thread takes increments from the global counter in blocks, so that threads
+    // generating OIDs at the same time do not all contend on the counter's cache line.
+    const uint32_t kIncrementBlockSize = 128;
+
+    // The most increments genMany reserves at once.
+    const uint32_t kMaxIncrementReservation = 64 * 1024;
+
+    // A thread's unused increments. They may only be used during the second they were reserved
+    // in: an increment is only unique for as long as the counter takes to wrap, and a block
+    // kept longer could be reissued to another thread by the time it is used.
+    struct IncrementBlock {
+        IncrementBlock() : timestamp(0), next(0), remaining(0) {}
+
+        OID::Timestamp timestamp;
+        uint32_t next;
+        uint32_t remaining;
+    };
+
+    OID::Increment makeIncrement(uint32_t value) {
+        OID::Increment incr;
+        incr.bytes[0] = uint8_t(value >> 16);
+        incr.bytes[1] = uint8_t(value >> 8);
+        incr.bytes[2] = uint8_t(value);
+        return incr;
+    }
+}  // namespace
+
+    TSP_DECLARE(IncrementBlock, threadIncrementBlock);
+    TSP_DEFINE(IncrementBlock, threadIncrementBlock);
+
+namespace {
+    // Returns the calling thread's increment block for OIDs with timestamp 'now', with room
+    // for at least one increment and, if possible, for 'wanted'.
+    IncrementBlock* reserveIncrements(OID::Timestamp now, size_t wanted) {
+        IncrementBlock* block = threadIncrementBlock.getMake();
+        if (block->timestamp != now) {
+            block->timestamp = now;
+            block->remaining = 0;
+        }
+        if (block->remaining == 0) {
+            const uint32_t size = uint32_t(std::max<size_t>(
+                kIncrementBlockSize,
+                std::min<size_t>(wanted, kMaxIncrementReservation)));
+            block->next = counter->fetchAndAdd(size);
+            block->remaining = size;
+        }
+        return block;
+    }
 }  // namespace
 
     MONGO_INITIALIZER_GENERAL(OIDGeneration, MONGO_NO_PREREQUISITES, ("default"))
@@ -50,14 +102,9 @@ namespace {
     }
 
     OID::Increment OID::Increment::next() {
-        uint64_t nextCtr = counter->fetchAndAdd(1);
-        OID::Increment incr;
-
-        incr.bytes[0] = uint8_t(nextCtr >> 16);
-        incr.bytes[1] = uint8_t(nextCtr >> 8);
-        incr.bytes[2] = uint8_t(nextCtr);
-
-        return incr;
+        IncrementBlock* block = reserveIncrements(time(0), 1);
+        --block->remaining;
+        return makeIncrement(block->next++);
     }
 
     OID::InstanceUnique OID::InstanceUnique::generate(SecureRandom& entropy) {
@@ -123,10 +170,28 @@ namespace {
     }
 
     void OID::init() {
+        const Timestamp now = time(0);
+        IncrementBlock* block = reserveIncrements(now, 1);
+        --block->remaining;
+
         // each set* method handles endianness
-        setTimestamp(time(0));
+        setTimestamp(now);
         setInstanceUnique(_instanceUnique);
-        setIncrement(Increment::next());
+        setIncrement(makeIncrement(block->next++));
+    }
+
+    void OID::genMany(OID* out, size_t n) {
+        const Timestamp now = time(0);
+        const InstanceUnique unique = _instanceUnique;
+
+        for (size_t i = 0; i < n;) {
+            IncrementBlock* block = reserveIncrements(now, n - i);
+            for (; block->remaining > 0 && i < n; --block->remaining, ++i) {
+                out[i].setTimestamp(now);
+                out[i].setInstanceUnique(unique);
+                out[i].setIncrement(makeIncrement(block->next++));
+            }
+        }
     }
 
     void OID::init( const std::string& s ) {
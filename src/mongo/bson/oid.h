@@ -104,6 +104,13 @@ namespace mongo {
             return o;
         }
 
+        /**
+         * Sets out[0] to out[n - 1] to new OIDs, as n calls to gen() would, for filling a
+         * batch of documents. The clock and the global counter are read once for the whole
+         * batch rather than once for each OID.
+         */
+        static void MONGO_CLIENT_FUNC genMany(OID* out, size_t n);
+
         // Caller must ensure that the buffer is valid for kOIDSize bytes.
         // this is templated because some places use unsigned char vs signed char
         template<typename T>
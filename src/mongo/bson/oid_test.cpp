@@ -15,6 +15,11 @@
 
 #include "mongo/bson/oid.h"
 
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <vector>
+
 #include "mongo/platform/endian.h"
 #include "mongo/unittest/unittest.h"
 
@@ -45,6 +50,48 @@ namespace {
         ASSERT_TRUE(o1 < o2);
     }
 
+    TEST(Increasing, AcrossGenMany) {
+        const size_t numOIDs = 1000;
+        std::vector<OID> oids(numOIDs + 2);
+        oids[0] = OID::gen();
+        OID::genMany(&oids[1], numOIDs);
+        oids[numOIDs + 1] = OID::gen();
+
+        for (size_t i = 1; i < oids.size(); ++i) {
+            ASSERT_TRUE(oids[i - 1] < oids[i]);
+            ASSERT_TRUE(std::memcmp(oids[0].getInstanceUnique().bytes,
+                                    oids[i].getInstanceUnique().bytes,
+                                    OID::kInstanceUniqueSize) == 0);
+        }
+    }
+
+    void genOIDs(std::vector<OID>* oids) {
+        for (size_t i = 0; i < oids->size(); i += 10) {
+            if (i % 100 == 0)
+                OID::genMany(&(*oids)[i], 10);
+            else
+                for (size_t j = i; j < i + 10; ++j)
+                    (*oids)[j] = OID::gen();
+        }
+    }
+
+    TEST(Unique, ManyThreads) {
+        const size_t numThreads = 8;
+        const size_t numOIDsPerThread = 20000;
+        std::vector<std::vector<OID> > oids(numThreads, std::vector<OID>(numOIDsPerThread));
+
+        boost::thread_group threads;
+        for (size_t i = 0; i < numThreads; ++i)
+            threads.create_thread(boost::bind(&genOIDs, &oids[i]));
+        threads.join_all();
+
+        std::vector<OID> all;
+        for (size_t i = 0; i < numThreads; ++i)
+            all.insert(all.end(), oids[i].begin(), oids[i].end());
+        std::sort(all.begin(), all.end());
+        ASSERT_TRUE(std::adjacent_find(all.begin(), all.end()) == all.end());
+    }
+
     TEST(IsSet, Simple) {
         OID o;
         ASSERT_FALSE(o.isSet());
@@ -340,6 +340,11 @@ namespace mongo {
             }
         }
 
+        /** like appendDoubleNice, but without forcing a ".0" onto integral values */
+        void appendDoublePrecise( double x ) {
+            SBNUM( x , MONGO_DBL_SIZE , "%.16g" );
+        }
+
         void write( const char* buf, int len) { memcpy( _buf.grow( len ) , buf , len ); }
 
         void append( const StringData& str ) { str.copyTo( _buf.grow( str.size() ), false ); }
@@ -18,8 +18,13 @@
 #include "mongo/client/bulk_operation_builder.h"
 
 #include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 
 #include "mongo/client/dbclientinterface.h"
+#include "mongo/client/exceptions.h"
 #include "mongo/client/insert_write_operation.h"
 #include "mongo/client/write_options.h"
 #include "mongo/client/write_result.h"
@@ -32,6 +37,21 @@ namespace mongo {
         }
     } // namespace
 
+    /** The batches of a parallel execution, shared by the threads writing them. */
+    struct BulkOperationBuilder::ParallelExecution {
+        ParallelExecution() : nextBatch(0), failed(false) {}
+
+        // Batch i is the operations from batchBounds[i] up to batchBounds[i + 1]. Its result
+        // is only touched by the thread that took it.
+        std::vector<size_t> batchBounds;
+        std::vector<WriteResult> batchResults;
+
+        boost::mutex mutex;
+        size_t nextBatch;
+        bool failed;
+        BSONObj error;
+    };
+
     BulkOperationBuilder::BulkOperationBuilder(DBClientBase* const client, const std::string& ns, bool ordered)
         : _client(client)
         , _ns(ns)
@@ -73,6 +93,111 @@ namespace mongo {
         _client->_write(_ns, _write_operations, _ordered, writeConcern, writeResult);
     }
 
+    void BulkOperationBuilder::executeParallel(const WriteConcern* writeConcern,
+                                               WriteResult* writeResult,
+                                               int numConnections,
+                                               stdx::function<DBClientBase* ()> connectionFactory) {
+        uassert(0, "Only unordered bulk operations can be executed in parallel", !_ordered);
+        uassert(0, "Bulk operations cannot be re-executed", !_executed);
+        uassert(0, "Bulk operations cannot be executed without any operations",
+            !_write_operations.empty());
+        uassert(0, "Bulk operations need at least one connection to execute", numConnections > 0);
+
+        _executed = true;
+
+        std::sort(_write_operations.begin(), _write_operations.end(), compare);
+
+        // Split the operations as the writers would, so that each batch is sent as one
+        // message and no connection is left idle while another has several to send.
+        ParallelExecution execution;
+        const size_t maxBatchSize = _client->getMaxWriteBatchSize();
+        const int maxBatchBytes = _client->getMaxBsonObjectSize();
+        int batchBytes = 0;
+        execution.batchBounds.push_back(0);
+        for (size_t i = 0; i < _write_operations.size(); ++i) {
+            const size_t batchBegin = execution.batchBounds.back();
+            const int operationBytes = _write_operations[i]->incrementalSize();
+            if (i > batchBegin &&
+                (i - batchBegin == maxBatchSize ||
+                 batchBytes + operationBytes > maxBatchBytes ||
+                 _write_operations[i]->operationType() !=
+                    _write_operations[batchBegin]->operationType())) {
+                execution.batchBounds.push_back(i);
+                batchBytes = 0;
+            }
+            batchBytes += operationBytes;
+        }
+        execution.batchBounds.push_back(_write_operations.size());
+        execution.batchResults.resize(execution.batchBounds.size() - 1);
+
+        std::vector<DBClientBase*> connections(1, _client);
+        const size_t maxConnections = std::min(static_cast<size_t>(numConnections),
+                                               execution.batchResults.size());
+        while (connections.size() < maxConnections)
+            connections.push_back(connectionFactory());
+
+        boost::thread_group threads;
+        try {
+            for (size_t i = 1; i < connections.size(); ++i)
+                threads.create_thread(boost::bind(&BulkOperationBuilder::_executeBatches,
+                                                  this, connections[i], writeConcern,
+                                                  &execution));
+        } catch (const boost::thread_resource_error&) {
+            // Carry on with the threads already started; they take the remaining batches.
+        }
+        _executeBatches(_client, writeConcern, &execution);
+        threads.join_all();
+
+        for (size_t i = 0; i < execution.batchResults.size(); ++i)
+            writeResult->_mergeWriteResult(execution.batchResults[i]);
+
+        if (execution.failed)
+            throw OperationException(execution.error);
+        writeResult->_check(true);
+    }
+
+    void BulkOperationBuilder::_executeBatches(DBClientBase* conn,
+                                               const WriteConcern* writeConcern,
+                                               ParallelExecution* execution) {
+        while (true) {
+            size_t batch;
+            {
+                boost::lock_guard<boost::mutex> lk(execution->mutex);
+                if (execution->failed || execution->nextBatch == execution->batchResults.size())
+                    return;
+                batch = execution->nextBatch++;
+            }
+
+            const std::vector<WriteOperation*> batchOps(
+                _write_operations.begin() + execution->batchBounds[batch],
+                _write_operations.begin() + execution->batchBounds[batch + 1]);
+            WriteResult& batchResult = execution->batchResults[batch];
+            batchResult._requiresDetailedInsertResults = true;
+
+            BSONObj error;
+            try {
+                conn->_write(_ns, batchOps, false, writeConcern, &batchResult);
+            }
+            catch (const OperationException& ex) {
+                if (!batchResult._isOwnWriteError(ex.obj()) &&
+                    !batchResult._isOwnWriteConcernError(ex.obj()))
+                    error = ex.obj().getOwned();
+            }
+            catch (const std::exception& ex) {
+                error = WriteResult::_errorFromException(ex);
+            }
+
+            if (!error.isEmpty()) {
+                boost::lock_guard<boost::mutex> lk(execution->mutex);
+                if (!execution->failed) {
+                    execution->failed = true;
+                    execution->error = error;
+                }
+                return;
+            }
+        }
+    }
+
     void BulkOperationBuilder::enqueue(WriteOperation* operation) {
         operation->setBulkIndex(_currentIndex++);
         _write_operations.push_back(operation);
@@ -20,6 +20,7 @@
 #include "mongo/bson/bsonobj.h"
 #include "mongo/client/bulk_update_builder.h"
 #include "mongo/client/write_result.h"
+#include "mongo/stdx/functional.h"
 
 namespace mongo {
 
@@ -100,9 +101,43 @@ namespace mongo {
          */
         void execute(const WriteConcern* writeConcern, WriteResult* writeResult);
 
+        /**
+         * Executes an unordered bulk operation over several connections at once.
+         *
+         * The operations are split into batches as execute() would split them, and each
+         * connection writes the next batch not yet taken until none are left, so that the
+         * server applies several batches concurrently. The results of every batch are merged
+         * into 'writeResult', which is checked as execute() checks it.
+         *
+         * A failure other than a write error, such as a lost connection, stops the batches
+         * not yet taken from being written and is thrown as an OperationException once those
+         * already taken are done.
+         *
+         * @note Warning: One must delete any new connections created by the connection factory
+         *  after use.
+         *
+         * @param writeConcern The write concern for every batch. 0 = default (acknowledged);
+         * @param writeResult Where the merged results of all of the batches will go.
+         * @param numConnections The most connections to write on, this builder's included.
+         * @param connectionFactory Function that returns a pointer to a DBClientBase connected
+         *  to the same server, called once for each connection beyond the first. See
+         *  DBClientBase::parallelScan for an example.
+         */
+        void executeParallel(const WriteConcern* writeConcern,
+                             WriteResult* writeResult,
+                             int numConnections,
+                             stdx::function<DBClientBase* ()> connectionFactory);
+
     private:
+        struct ParallelExecution;
+
         void enqueue(WriteOperation* const operation);
 
+        // Writes batches taken from 'execution' on 'conn' until none are left or one fails.
+        void _executeBatches(DBClientBase* conn,
+                             const WriteConcern* writeConcern,
+                             ParallelExecution* execution);
+
         DBClientBase* const _client;
         const std::string _ns;
         const bool _ordered;
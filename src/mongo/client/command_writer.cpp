@@ -17,17 +17,27 @@
 
 #include "mongo/client/command_writer.h"
 
+#include <deque>
+
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/client/write_result.h"
+#include "mongo/db/dbmessage.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
     const int kOverhead = 8 * 1024;
+    const int kInitialBufferSize = 16 * 1024;
     const char kOrderedKey[] = "ordered";
 
-    CommandWriter::CommandWriter(DBClientBase* client) : _client(client) {
-    }
+    // writeOne() keeps a buffer up to this size between calls and frees a larger one.
+    const int kMaxRetainedBufferSize = 64 * 1024;
+
+    CommandWriter::CommandWriter(DBClientBase* client)
+        : _client(client)
+        , _singleOp(1)
+    {}
 
     void CommandWriter::write(
         const StringData& ns,
@@ -36,6 +46,15 @@ namespace mongo {
         const WriteConcern* writeConcern,
         WriteResult* writeResult
     ) {
+        // Replies are matched to batches by arrival order, which only holds on a single
+        // socket. Replica set connections track one outstanding lazy request at most.
+        const int maxBatchesInFlight = _client->getMaxWriteBatchesInFlight();
+        if (!ordered && maxBatchesInFlight > 1 && _client->lazySupported()
+            && _client->type() == ConnectionString::MASTER) {
+            _writePipelined(ns, write_operations, writeConcern, writeResult, maxBatchesInFlight);
+            return;
+        }
+
         // Effectively a map of batch relative indexes to WriteOperations
         std::vector<WriteOperation*> batchOps;
 
@@ -44,72 +63,201 @@ namespace mongo {
 
         while (batch_begin != end) {
 
-            boost::scoped_ptr<BSONObjBuilder> command(new BSONObjBuilder);
-            boost::scoped_ptr<BSONArrayBuilder> batch(new BSONArrayBuilder);
-            std::vector<WriteOperation*>::const_iterator batch_iter = batch_begin;
+            Message toSend;
+            std::vector<WriteOperation*>::const_iterator batch_iter = _buildBatch(
+                ns, batch_begin, end, ordered, writeConcern, &toSend, &batchOps);
 
-            // We must be able to fit the first item of the batch. Otherwise, the calling code
-            // passed an over size write operation in violation of our contract.
-            invariant(_fits(batch.get(), *batch_iter));
+            // Issue the complete command.
+            BSONObj batchResult = _send(&toSend);
 
-            // Set the current operation type
-            const WriteOpType batchOpType = (*batch_iter)->operationType();
+            // Merge this batch's result into the result for all batches written.
+            writeResult->_mergeCommandResult(batchOps, batchResult);
+            batchOps.clear();
 
-            // Begin the command for this batch.
-            (*batch_iter)->startCommand(ns.toString(), command.get());
+            // Check write result for errors if we are doing ordered processing or last op
+            bool lastOp = *batch_iter == write_operations.back();
+            if (ordered || lastOp)
+                writeResult->_check(lastOp);
 
-            while (true) {
+            // The next batch begins with the op after the last one in the just issued batch.
+            batch_begin = ++batch_iter;
+        }
 
-                // Always safe to append here: either we just entered the loop, or all the
-                // checks below passed.
-                (*batch_iter)->appendSelfToCommand(batch.get());
+    }
 
-                // Associate batch index with WriteOperation
-                batchOps.push_back(*batch_iter);
+    void CommandWriter::_writePipelined(
+        const StringData& ns,
+        const std::vector<WriteOperation*>& write_operations,
+        const WriteConcern* writeConcern,
+        WriteResult* writeResult,
+        size_t maxBatchesInFlight
+    ) {
+        // Batches sent but not yet replied to, oldest first.
+        std::deque<InFlightBatch> inFlight;
+
+        std::vector<WriteOperation*>::const_iterator batch_begin = write_operations.begin();
+        const std::vector<WriteOperation*>::const_iterator end = write_operations.end();
 
-                // Peek at the next operation.
-                const std::vector<WriteOperation*>::const_iterator next = boost::next(batch_iter);
+        // The first failed command, if any. Once a command fails no more batches are sent,
+        // but the replies to those already sent must still be read off the socket.
+        BSONObj failure;
 
-                // If we are out of operations, issue what we have.
-                if (next == end)
-                    break;
+        while (!inFlight.empty() || (batch_begin != end && failure.isEmpty())) {
 
-                // If the next operation is of a different type, issue what we have.
-                if ((*next)->operationType() != batchOpType)
-                    break;
+            if (batch_begin != end && failure.isEmpty() && inFlight.size() < maxBatchesInFlight) {
+                inFlight.push_back(InFlightBatch());
+                InFlightBatch& batch = inFlight.back();
 
-                // If adding the next op would put us over the limit of ops in a batch, issue
-                // what we have.
-                if (std::distance(batch_begin, next) >= _client->getMaxWriteBatchSize())
-                    break;
+                Message toSend;
+                std::vector<WriteOperation*>::const_iterator batch_iter = _buildBatch(
+                    ns, batch_begin, end, false, writeConcern, &toSend, &batch.ops);
+                batch.requestId = _sendLazy(&toSend);
 
-                // If we can't put the next item into the current batch, issue what we have.
-                if (!_fits(batch.get(), *next))
-                    break;
+                batch_begin = ++batch_iter;
+                continue;
+            }
 
-                // OK to proceed to next op.
-                batch_iter = next;
+            BSONObj batchResult;
+            if (_recvLazy(inFlight.front().requestId, &batchResult)) {
+                writeResult->_mergeCommandResult(inFlight.front().ops, batchResult);
+            }
+            else if (failure.isEmpty()) {
+                failure = batchResult;
             }
+            inFlight.pop_front();
+        }
 
-            // End the command for this batch.
-            _endCommand(batch.get(), *batch_iter, ordered, command.get());
+        if (!failure.isEmpty())
+            throw OperationException(failure);
 
-            // Issue the complete command.
-            BSONObj batchResult = _send(command.get(), writeConcern, ns);
+        writeResult->_check(true);
+    }
 
-            // Merge this batch's result into the result for all batches written.
-            writeResult->_mergeCommandResult(batchOps, batchResult);
-            batchOps.clear();
+    std::vector<WriteOperation*>::const_iterator CommandWriter::_buildBatch(
+        const StringData& ns,
+        std::vector<WriteOperation*>::const_iterator batch_begin,
+        std::vector<WriteOperation*>::const_iterator end,
+        bool ordered,
+        const WriteConcern* writeConcern,
+        Message* toSend,
+        std::vector<WriteOperation*>* batchOps
+    ) {
+        // The command is built directly after the OP_QUERY header in the buffer that becomes
+        // the outgoing message, so each operation is copied exactly once.
+        BufBuilder buffer(kInitialBufferSize);
+        _startQuery(ns, &buffer);
 
-            // Check write result for errors if we are doing ordered processing or last op
-            bool lastOp = *batch_iter == write_operations.back();
-            if (ordered || lastOp)
-                writeResult->_check(lastOp);
+        BSONObjBuilder command(buffer);
+        std::vector<WriteOperation*>::const_iterator batch_iter = batch_begin;
 
-            // The next batch begins with the op after the last one in the just issued batch.
-            batch_begin = ++batch_iter;
+        // Begin the command for this batch.
+        (*batch_iter)->startCommand(ns.toString(), &command);
+        BSONArrayBuilder batch(command.subarrayStart((*batch_iter)->batchName()));
+
+        // We must be able to fit the first item of the batch. Otherwise, the calling code
+        // passed an over size write operation in violation of our contract.
+        invariant(_fits(&batch, *batch_iter));
+
+        // Set the current operation type
+        const WriteOpType batchOpType = (*batch_iter)->operationType();
+
+        while (true) {
+
+            // Always safe to append here: either we just entered the loop, or all the
+            // checks below passed.
+            (*batch_iter)->appendSelfToCommand(&batch);
+
+            // Associate batch index with WriteOperation
+            batchOps->push_back(*batch_iter);
+
+            // Peek at the next operation.
+            const std::vector<WriteOperation*>::const_iterator next = boost::next(batch_iter);
+
+            // If we are out of operations, issue what we have.
+            if (next == end)
+                break;
+
+            // If the next operation is of a different type, issue what we have.
+            if ((*next)->operationType() != batchOpType)
+                break;
+
+            // If adding the next op would put us over the limit of ops in a batch, issue
+            // what we have.
+            if (std::distance(batch_begin, next) >= _client->getMaxWriteBatchSize())
+                break;
+
+            // If we can't put the next item into the current batch, issue what we have.
+            if (!_fits(&batch, *next))
+                break;
+
+            // OK to proceed to next op.
+            batch_iter = next;
         }
 
+        // End the command for this batch.
+        batch.doneFast();
+        _endCommand(ordered, writeConcern, &command);
+        command.doneFast();
+
+        _finishQuery(&buffer);
+        toSend->setData(buffer.buf(), true);
+        buffer.decouple();
+
+        return batch_iter;
+    }
+
+    void CommandWriter::writeOne(
+        const std::string& ns,
+        WriteOperation* op,
+        const WriteConcern* writeConcern,
+        WriteResult* writeResult
+    ) {
+        uassert(0, "write command exceeds maxBsonObjectSize",
+                op->incrementalSize() + kOverhead <= _client->getMaxBsonObjectSize());
+
+        _buffer.reset(kMaxRetainedBufferSize);
+        _startQuery(ns, &_buffer);
+
+        BSONObjBuilder command(_buffer);
+        op->startCommand(ns, &command);
+        BSONArrayBuilder batch(command.subarrayStart(op->batchName()));
+        op->appendSelfToCommand(&batch);
+        batch.doneFast();
+        _endCommand(true, writeConcern, &command);
+        command.doneFast();
+
+        // The message is sent from the buffer, which it does not take ownership of.
+        _finishQuery(&_buffer);
+        Message toSend(_buffer.buf(), false);
+
+        Message response;
+        _client->call(toSend, response);
+
+        // The reply is read where it was received, and only copied if there is an error to
+        // report.
+        BSONObj result;
+        if (!_parseReply(response, &result))
+            throw OperationException(result.getOwned());
+
+        _singleOp[0] = op;
+        writeResult->_mergeCommandResult(_singleOp, result);
+        writeResult->_check(true);
+    }
+
+    void CommandWriter::_startQuery(const StringData& ns, BufBuilder* buffer) {
+        // See query.h for the layout of the header.
+        buffer->skip(MsgData::MsgDataHeaderSize);
+        buffer->appendNum(0); // query options
+        buffer->appendStr(nsToDatabaseSubstring(ns), false);
+        buffer->appendStr(".$cmd");
+        buffer->appendNum(0); // nToSkip
+        buffer->appendNum(-1); // nToReturn
+    }
+
+    void CommandWriter::_finishQuery(BufBuilder* buffer) {
+        MsgData::View header = buffer->buf();
+        header.setLen(buffer->len());
+        header.setOperation(dbQuery);
     }
 
     bool CommandWriter::_fits(BSONArrayBuilder* builder, WriteOperation* operation) {
@@ -119,32 +267,83 @@ namespace mongo {
         // This update is too large to ever be sent as a command, assert
         uassert(0, "update command exceeds maxBsonObjectSize", opSize <= maxSize);
 
+        // The builder shares the message buffer, so its length also counts the message and
+        // command headers. Those are small enough to come out of kOverhead.
         return (builder->len() + opSize + kOverhead) <= maxSize;
     }
 
     void CommandWriter::_endCommand(
-        BSONArrayBuilder* batch,
-        WriteOperation* operation,
         bool ordered,
+        const WriteConcern* writeConcern,
         BSONObjBuilder* command
     ) {
-        command->append(operation->batchName(), batch->arr());
         command->append(kOrderedKey, ordered);
+
+        BSONObjBuilder writeConcernBuilder(command->subobjStart("writeConcern"));
+        writeConcern->appendSelfToBSONObj(&writeConcernBuilder);
+        writeConcernBuilder.doneFast();
+
+        if (DBClientWithCommands::RunCommandHookFunc hook = _client->getRunCommandHook())
+            hook(command);
     }
 
-    BSONObj CommandWriter::_send(
-        BSONObjBuilder* command,
-        const WriteConcern* writeConcern,
-        const StringData& ns
-    ) {
-        command->append("writeConcern", writeConcern->obj());
+    BSONObj CommandWriter::_send(Message* toSend) {
+        Message response;
+        _client->call(*toSend, response);
 
         BSONObj result;
-        bool commandWorked = _client->runCommand(nsToDatabase(ns), command->obj(), result);
-
-        if (!commandWorked) throw OperationException(result);
+        const bool ok = _parseReply(response, &result);
+        result = result.getOwned();
+        if (!ok)
+            throw OperationException(result);
 
         return result;
     }
 
+    MSGID CommandWriter::_sendLazy(Message* toSend) {
+        _client->say(*toSend);
+        return toSend->header().getId();
+    }
+
+    bool CommandWriter::_recvLazy(MSGID requestId, BSONObj* result) {
+        Message response;
+        uassert(0, str::stream() << "error receiving write command reply from "
+                                 << _client->getServerAddress(),
+                _client->recv(response));
+
+        uassert(0, str::stream() << "write command reply responds to request "
+                                 << response.header().getResponseTo()
+                                 << ", expected " << requestId,
+                response.header().getResponseTo() == requestId);
+
+        const bool ok = _parseReply(response, result);
+        *result = result->getOwned();
+        return ok;
+    }
+
+    bool CommandWriter::_parseReply(Message& response, BSONObj* result) {
+        uassert(0, str::stream() << "empty write command reply from "
+                                 << _client->getServerAddress(),
+                !response.empty());
+
+        QueryResult::View qr = response.singleData().view2ptr();
+        uassert(0, "write command reply contains no documents", qr.getNReturned() == 1);
+
+        // Lets replica set connections notice a "not master" reply.
+        bool retry = false;
+        std::string host;
+        _client->checkResponse(qr.data(), qr.getNReturned(), &retry, &host);
+
+        *result = BSONObj(qr.data());
+
+        if (DBClientWithCommands::PostRunCommandHookFunc hook = _client->getPostRunCommandHook()) {
+            *result = result->getOwned();
+            hook(*result, _client->getServerAddress());
+        }
+
+        if (qr.getResultFlags() & ResultFlag_ErrSet)
+            return false;
+        return (*result)["ok"].trueValue();
+    }
+
 } // namespace mongo
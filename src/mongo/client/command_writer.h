@@ -16,6 +16,7 @@
 #pragma once
 
 #include "mongo/client/dbclient_writer.h"
+#include "mongo/util/net/message.h"
 
 namespace mongo {
 
@@ -33,22 +34,81 @@ namespace mongo {
             WriteResult* writeResult
         );
 
+        virtual void writeOne(
+            const std::string& ns,
+            WriteOperation* op,
+            const WriteConcern* writeConcern,
+            WriteResult* writeResult
+        );
+
     private:
-        void _endCommand(
-            BSONArrayBuilder* batch,
-            WriteOperation* op, bool ordered,
-            BSONObjBuilder* command
+        struct InFlightBatch {
+            InFlightBatch() : requestId(0) {}
+
+            MSGID requestId;
+
+            // Effectively a map of batch relative indexes to WriteOperations
+            std::vector<WriteOperation*> ops;
+        };
+
+        // Builds an OP_QUERY message holding a write command with as many operations
+        // starting at 'begin' as fit into one batch, recording them in 'batchOps'. Returns the
+        // last operation in the batch.
+        std::vector<WriteOperation*>::const_iterator _buildBatch(
+            const StringData& ns,
+            std::vector<WriteOperation*>::const_iterator begin,
+            std::vector<WriteOperation*>::const_iterator end,
+            bool ordered,
+            const WriteConcern* writeConcern,
+            Message* toSend,
+            std::vector<WriteOperation*>* batchOps
         );
 
-        BSONObj _send(
-            BSONObjBuilder* command,
+        // Unordered writes with more than one batch in flight. Batches are sent until
+        // maxBatchesInFlight are awaiting replies, then each reply read makes room to send the
+        // next, so the server need not sit idle waiting on the client for another batch.
+        void _writePipelined(
+            const StringData& ns,
+            const std::vector<WriteOperation*>& write_operations,
             const WriteConcern* writeConcern,
-            const StringData& ns
+            WriteResult* writeResult,
+            size_t maxBatchesInFlight
         );
 
+        // Appends the OP_QUERY header and preamble for a command on the database of 'ns'.
+        static void _startQuery(const StringData& ns, BufBuilder* buffer);
+
+        // Sets the length and operation in the header of the message in 'buffer'.
+        static void _finishQuery(BufBuilder* buffer);
+
+        void _endCommand(
+            bool ordered,
+            const WriteConcern* writeConcern,
+            BSONObjBuilder* command
+        );
+
+        // Sends a command and waits for the reply. Throws if the command failed.
+        BSONObj _send(Message* toSend);
+
+        // Sends a command without waiting for its reply. Returns the request id.
+        MSGID _sendLazy(Message* toSend);
+
+        // Receives the reply to the command sent with request id 'requestId'. Returns false
+        // if the command failed, in which case 'result' holds the error.
+        bool _recvLazy(MSGID requestId, BSONObj* result);
+
+        // Sets 'result' to the reply in 'response'. The reply is not copied, so 'result' is
+        // only valid as long as 'response' is, unless a PostRunCommandHook had to be given it.
+        // Returns false if the command failed.
+        bool _parseReply(Message& response, BSONObj* result);
+
         bool _fits(BSONArrayBuilder* builder, WriteOperation* operation);
 
         DBClientBase* const _client;
+
+        // The buffer writeOne() builds its commands in, and the operation it is writing.
+        BufBuilder _buffer;
+        std::vector<WriteOperation*> _singleOp;
     };
 
 } // namespace mongo
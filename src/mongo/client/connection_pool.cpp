@@ -0,0 +1,306 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/client/connection_pool.h"
+
+#include "mongo/client/sasl_client_authenticate.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    const size_t DBClientConnectionPool::kDefaultMinPoolSizePerHost;
+    const size_t DBClientConnectionPool::kDefaultMaxPoolSizePerHost;
+    const int DBClientConnectionPool::kDefaultMaxIdleTimeMillis;
+    const int DBClientConnectionPool::kDefaultCheckoutTimeoutMillis;
+
+    namespace {
+        void destroyAll(const std::vector<DBClientConnection*>& conns) {
+            for (size_t i = 0; i < conns.size(); ++i)
+                delete conns[i];
+        }
+    } // namespace
+
+    DBClientConnectionPool::DBClientConnectionPool(double socketTimeout)
+        : _socketTimeout(socketTimeout)
+        , _minPoolSize(kDefaultMinPoolSizePerHost)
+        , _maxPoolSize(kDefaultMaxPoolSizePerHost)
+        , _maxIdleTimeMillis(kDefaultMaxIdleTimeMillis)
+        , _checkoutTimeoutMillis(kDefaultCheckoutTimeoutMillis)
+    {}
+
+    DBClientConnectionPool::~DBClientConnectionPool() {
+        for (HostPoolMap::iterator it = _pools.begin(); it != _pools.end(); ++it) {
+            if (it->second.inUse != 0) {
+                warning() << "destroying connection pool with " << it->second.inUse
+                          << " connections to " << it->first.toString() << " still checked out";
+            }
+        }
+        clear();
+    }
+
+    void DBClientConnectionPool::setMinPoolSizePerHost(size_t size) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        _minPoolSize = size;
+    }
+
+    size_t DBClientConnectionPool::getMinPoolSizePerHost() const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        return _minPoolSize;
+    }
+
+    void DBClientConnectionPool::setMaxPoolSizePerHost(size_t size) {
+        uassert(0, "maximum connection pool size must be positive", size > 0);
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        _maxPoolSize = size;
+        _connectionReleased.notify_all();
+    }
+
+    size_t DBClientConnectionPool::getMaxPoolSizePerHost() const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        return _maxPoolSize;
+    }
+
+    void DBClientConnectionPool::setMaxIdleTimeMillis(int millis) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        _maxIdleTimeMillis = millis;
+    }
+
+    int DBClientConnectionPool::getMaxIdleTimeMillis() const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        return _maxIdleTimeMillis;
+    }
+
+    void DBClientConnectionPool::setCheckoutTimeoutMillis(int millis) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        _checkoutTimeoutMillis = millis;
+    }
+
+    int DBClientConnectionPool::getCheckoutTimeoutMillis() const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        return _checkoutTimeoutMillis;
+    }
+
+    void DBClientConnectionPool::addCredentials(const BSONObj& params) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        _credentials[params[saslCommandUserDBFieldName].str()] = params.getOwned();
+    }
+
+    DBClientConnection* DBClientConnectionPool::get(const HostAndPort& host) {
+        std::vector<DBClientConnection*> reaped;
+        DBClientConnection* conn = NULL;
+        bool mustCreate = false;
+
+        while (!conn && !mustCreate) {
+            bool timedOut = false;
+            {
+                boost::unique_lock<boost::mutex> lk(_mutex);
+                HostPool& pool = _pools[host];
+                _reapIdle(&pool, curTimeMillis64(), &reaped);
+
+                const unsigned long long deadline = curTimeMillis64() + _checkoutTimeoutMillis;
+                while (pool.available.empty() &&
+                       pool.inUse + pool.available.size() >= _maxPoolSize) {
+                    if (_checkoutTimeoutMillis <= 0) {
+                        _connectionReleased.wait(lk);
+                        continue;
+                    }
+
+                    const unsigned long long now = curTimeMillis64();
+                    if (now >= deadline) {
+                        timedOut = true;
+                        break;
+                    }
+                    _connectionReleased.timed_wait(
+                        lk, boost::posix_time::milliseconds(deadline - now));
+                }
+
+                if (!timedOut) {
+                    pool.inUse++;
+                    if (pool.available.empty()) {
+                        mustCreate = true;
+                    }
+                    else {
+                        conn = pool.available.back().conn;
+                        pool.available.pop_back();
+                    }
+                }
+            }
+
+            destroyAll(reaped);
+            reaped.clear();
+
+            uassert(0, str::stream() << "timed out waiting for a connection to "
+                                     << host.toString() << " from the pool",
+                    !timedOut);
+
+            // Health check outside of the lock, since it may poll the socket.
+            if (conn && !_isHealthy(conn)) {
+                LOG(1) << "discarding unhealthy pooled connection to " << host.toString();
+                kill(host, conn);
+                conn = NULL;
+            }
+        }
+
+        if (conn)
+            return conn;
+
+        try {
+            return _create(host);
+        }
+        catch (...) {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            _pools[host].inUse--;
+            _connectionReleased.notify_one();
+            throw;
+        }
+    }
+
+    void DBClientConnectionPool::release(const HostAndPort& host, DBClientConnection* conn) {
+        if (conn->isFailed()) {
+            kill(host, conn);
+            return;
+        }
+
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        HostPool& pool = _pools[host];
+        verify(pool.inUse > 0);
+        pool.inUse--;
+        pool.available.push_back(PooledConnection(conn, curTimeMillis64()));
+        _connectionReleased.notify_one();
+    }
+
+    void DBClientConnectionPool::kill(const HostAndPort& host, DBClientConnection* conn) {
+        delete conn;
+
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        HostPool& pool = _pools[host];
+        verify(pool.inUse > 0);
+        pool.inUse--;
+        _connectionReleased.notify_one();
+    }
+
+    void DBClientConnectionPool::reapIdleConnections() {
+        std::vector<DBClientConnection*> reaped;
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            const unsigned long long now = curTimeMillis64();
+            for (HostPoolMap::iterator it = _pools.begin(); it != _pools.end(); ++it)
+                _reapIdle(&it->second, now, &reaped);
+        }
+        destroyAll(reaped);
+    }
+
+    void DBClientConnectionPool::clear() {
+        std::vector<DBClientConnection*> idle;
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            for (HostPoolMap::iterator it = _pools.begin(); it != _pools.end(); ++it) {
+                std::deque<PooledConnection>& available = it->second.available;
+                for (size_t i = 0; i < available.size(); ++i)
+                    idle.push_back(available[i].conn);
+                available.clear();
+            }
+            _connectionReleased.notify_all();
+        }
+        destroyAll(idle);
+    }
+
+    size_t DBClientConnectionPool::getNumAvailableConnections(const HostAndPort& host) const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        HostPoolMap::const_iterator it = _pools.find(host);
+        return it == _pools.end() ? 0 : it->second.available.size();
+    }
+
+    size_t DBClientConnectionPool::getNumInUseConnections(const HostAndPort& host) const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        HostPoolMap::const_iterator it = _pools.find(host);
+        return it == _pools.end() ? 0 : it->second.inUse;
+    }
+
+    DBClientConnection* DBClientConnectionPool::_create(const HostAndPort& host) {
+        std::map<std::string, BSONObj> credentials;
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            credentials = _credentials;
+        }
+
+        std::string errmsg;
+        std::auto_ptr<DBClientBase> base(ConnectionString(host).connect(errmsg, _socketTimeout));
+        uassert(0, str::stream() << "failed to connect to " << host.toString() << ": " << errmsg,
+                base.get());
+
+        DBClientConnection* conn = dynamic_cast<DBClientConnection*>(base.get());
+        uassert(0, str::stream() << "connection to " << host.toString()
+                                 << " is not a DBClientConnection",
+                conn);
+
+        // Authentication goes through DBClientConnection::_auth, which also records the
+        // credentials in the connection's auth cache for replay on reconnect.
+        for (std::map<std::string, BSONObj>::const_iterator it = credentials.begin();
+             it != credentials.end(); ++it) {
+            conn->auth(it->second);
+        }
+
+        LOG(1) << "created pooled connection to " << host.toString();
+        base.release();
+        return conn;
+    }
+
+    bool DBClientConnectionPool::_isHealthy(DBClientConnection* conn) {
+        // checks are ordered from cheap to expensive
+        return !conn->isFailed() && conn->isStillConnected();
+    }
+
+    void DBClientConnectionPool::_reapIdle(HostPool* pool, unsigned long long now,
+                                           std::vector<DBClientConnection*>* out) {
+        if (_maxIdleTimeMillis < 0)
+            return;
+
+        // The least recently used connections are at the front.
+        while (!pool->available.empty() &&
+               pool->inUse + pool->available.size() > _minPoolSize &&
+               now - pool->available.front().lastUsedMillis >
+                   static_cast<unsigned long long>(_maxIdleTimeMillis)) {
+            out->push_back(pool->available.front().conn);
+            pool->available.pop_front();
+        }
+    }
+
+    ScopedDBClientConnection::ScopedDBClientConnection(DBClientConnectionPool& pool,
+                                                       const HostAndPort& host)
+        : _pool(pool)
+        , _host(host)
+        , _conn(pool.get(host))
+    {}
+
+    ScopedDBClientConnection::~ScopedDBClientConnection() {
+        if (_conn)
+            _pool.kill(_host, _conn);
+    }
+
+    void ScopedDBClientConnection::done() {
+        verify(_conn);
+        _pool.release(_host, _conn);
+        _conn = NULL;
+    }
+
+} // namespace mongo
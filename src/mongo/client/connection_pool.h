@@ -0,0 +1,208 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/client/dbclientinterface.h"
+#include "mongo/client/export_macros.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/net/hostandport.h"
+
+namespace mongo {
+
+    /**
+     * A thread safe pool of DBClientConnections, keyed by host.
+     *
+     * Connections are checked out with get() and checked back in with release(). A checked out
+     * connection is owned exclusively by the caller until it is released, so many threads can
+     * share a bounded set of sockets without each paying for connect and authentication.
+     *
+     * Most callers should use ScopedDBClientConnection rather than calling get() and release()
+     * directly.
+     */
+    class MONGO_CLIENT_API DBClientConnectionPool {
+        MONGO_DISALLOW_COPYING(DBClientConnectionPool);
+    public:
+        static const size_t kDefaultMinPoolSizePerHost = 0;
+        static const size_t kDefaultMaxPoolSizePerHost = 50;
+        static const int kDefaultMaxIdleTimeMillis = 5 * 60 * 1000;
+        static const int kDefaultCheckoutTimeoutMillis = 0;
+
+        /**
+         * @param socketTimeout tcp timeout in seconds for the connections created by this pool.
+         */
+        explicit DBClientConnectionPool(double socketTimeout = 0);
+
+        /** Closes all idle connections. All checked out connections must have been released. */
+        ~DBClientConnectionPool();
+
+        /**
+         * Idle connections are never reaped if doing so would leave fewer than this many
+         * connections (idle and checked out) to a host.
+         *
+         * Default: 0
+         */
+        void setMinPoolSizePerHost(size_t size);
+        size_t getMinPoolSizePerHost() const;
+
+        /**
+         * The maximum number of connections (idle and checked out) to a single host. A get()
+         * on a host at its limit waits for another thread to release a connection.
+         *
+         * Default: 50
+         */
+        void setMaxPoolSizePerHost(size_t size);
+        size_t getMaxPoolSizePerHost() const;
+
+        /**
+         * Connections that have been idle in the pool for longer than this are closed. A
+         * negative value disables idle reaping.
+         *
+         * Default: 300000 ms
+         */
+        void setMaxIdleTimeMillis(int millis);
+        int getMaxIdleTimeMillis() const;
+
+        /**
+         * How long get() waits for a connection on a host at its limit before throwing. Zero
+         * waits forever.
+         *
+         * Default: 0 ms (wait forever)
+         */
+        void setCheckoutTimeoutMillis(int millis);
+        int getCheckoutTimeoutMillis() const;
+
+        /**
+         * Records credentials that every connection created by this pool authenticates with.
+         * Connections already in the pool are not affected; use clear() to drop them. The
+         * credentials have the same format as DBClientWithCommands::auth, and are replayed by
+         * each connection's own auth cache if it has to reconnect.
+         */
+        void addCredentials(const BSONObj& params);
+
+        /**
+         * Checks out a connection to 'host', reusing an idle one if a healthy one is available
+         * and creating a new one otherwise. The caller owns the connection until it is passed
+         * back to release(). Throws if a connection cannot be created or the checkout times out.
+         */
+        DBClientConnection* get(const HostAndPort& host);
+
+        /**
+         * Checks a connection obtained from get() back in. Connections that have failed are
+         * destroyed rather than returned to the pool.
+         */
+        void release(const HostAndPort& host, DBClientConnection* conn);
+
+        /**
+         * Destroys a connection obtained from get() without returning it to the pool. Use this
+         * when the connection may be in an unknown state, e.g. after an exception mid-operation.
+         */
+        void kill(const HostAndPort& host, DBClientConnection* conn);
+
+        /** Closes idle connections older than the maximum idle time, on all hosts. */
+        void reapIdleConnections();
+
+        /** Closes all idle connections, on all hosts. Checked out connections are unaffected. */
+        void clear();
+
+        /** @return the number of idle connections to 'host'. */
+        size_t getNumAvailableConnections(const HostAndPort& host) const;
+
+        /** @return the number of checked out connections to 'host'. */
+        size_t getNumInUseConnections(const HostAndPort& host) const;
+
+    private:
+        struct PooledConnection {
+            PooledConnection(DBClientConnection* conn, unsigned long long lastUsedMillis)
+                : conn(conn)
+                , lastUsedMillis(lastUsedMillis) {}
+
+            DBClientConnection* conn;
+            unsigned long long lastUsedMillis;
+        };
+
+        struct HostPool {
+            HostPool() : inUse(0) {}
+
+            // Most recently used connections are at the back.
+            std::deque<PooledConnection> available;
+            size_t inUse;
+        };
+
+        typedef std::map<HostAndPort, HostPool> HostPoolMap;
+
+        // Creates and authenticates a new connection. Throws on failure. Must not be called
+        // with _mutex held.
+        DBClientConnection* _create(const HostAndPort& host);
+
+        // Checks that an idle connection is still usable. Must not be called with _mutex held.
+        static bool _isHealthy(DBClientConnection* conn);
+
+        // Moves idle connections past their maximum idle time from 'pool' to 'out'. Must be
+        // called with _mutex held.
+        void _reapIdle(HostPool* pool, unsigned long long now,
+                       std::vector<DBClientConnection*>* out);
+
+        const double _socketTimeout;
+
+        mutable boost::mutex _mutex;
+        boost::condition_variable _connectionReleased;
+
+        size_t _minPoolSize;
+        size_t _maxPoolSize;
+        int _maxIdleTimeMillis;
+        int _checkoutTimeoutMillis;
+
+        // Keyed by the user source database, like DBClientConnection's auth cache.
+        std::map<std::string, BSONObj> _credentials;
+
+        HostPoolMap _pools;
+    };
+
+    /**
+     * RAII checkout of a connection from a DBClientConnectionPool.
+     *
+     * The connection is returned to the pool only if done() is called. If the guard is destroyed
+     * without done(), e.g. because an exception unwound the stack, the connection is assumed to
+     * be in an unknown state and is destroyed instead.
+     */
+    class MONGO_CLIENT_API ScopedDBClientConnection {
+        MONGO_DISALLOW_COPYING(ScopedDBClientConnection);
+    public:
+        ScopedDBClientConnection(DBClientConnectionPool& pool, const HostAndPort& host);
+        ~ScopedDBClientConnection();
+
+        DBClientConnection* operator->() { return _conn; }
+        DBClientConnection& conn() { return *_conn; }
+        DBClientConnection* get() { return _conn; }
+
+        /** Returns the connection to the pool. The guard may not be used afterwards. */
+        void done();
+
+    private:
+        DBClientConnectionPool& _pool;
+        const HostAndPort _host;
+        DBClientConnection* _conn;
+    };
+
+} // namespace mongo
@@ -0,0 +1,214 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ * This file contains tests for DBClientConnectionPool. Connections are made to mock servers, so
+ * the tests only cover the pool bookkeeping.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/client/connection_pool.h"
+
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "mongo/dbtests/mock/mock_conn_registry.h"
+#include "mongo/dbtests/mock/mock_remote_db_server.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/time_support.h"
+
+namespace {
+
+    using mongo::ConnectionString;
+    using mongo::DBClientConnection;
+    using mongo::DBClientConnectionPool;
+    using mongo::HostAndPort;
+    using mongo::MockConnRegistry;
+    using mongo::MockRemoteDBServer;
+    using mongo::ScopedDBClientConnection;
+    using mongo::UserException;
+
+    const char kHostName[] = "$pool:27017";
+
+    class ConnectionPoolTest : public mongo::unittest::Test {
+    protected:
+        ConnectionPoolTest() : _host(kHostName) {}
+
+        void setUp() {
+            _server.reset(new MockRemoteDBServer(kHostName));
+            MockConnRegistry::get()->addServer(_server.get());
+            ConnectionString::setConnectionHook(MockConnRegistry::get()->getConnStrHook());
+        }
+
+        void tearDown() {
+            MockConnRegistry::get()->removeServer(kHostName);
+            _server.reset();
+        }
+
+        MockRemoteDBServer* server() {
+            return _server.get();
+        }
+
+        const HostAndPort& host() const {
+            return _host;
+        }
+
+    private:
+        const HostAndPort _host;
+        boost::scoped_ptr<MockRemoteDBServer> _server;
+    };
+
+    void releaseAfterDelay(DBClientConnectionPool* pool, const HostAndPort& host,
+                           DBClientConnection* conn) {
+        mongo::sleepmillis(50);
+        pool->release(host, conn);
+    }
+
+    TEST_F(ConnectionPoolTest, ReusesReleasedConnection) {
+        DBClientConnectionPool pool;
+
+        DBClientConnection* first = pool.get(host());
+        ASSERT_EQUALS(1U, pool.getNumInUseConnections(host()));
+        ASSERT_EQUALS(0U, pool.getNumAvailableConnections(host()));
+
+        pool.release(host(), first);
+        ASSERT_EQUALS(0U, pool.getNumInUseConnections(host()));
+        ASSERT_EQUALS(1U, pool.getNumAvailableConnections(host()));
+
+        DBClientConnection* second = pool.get(host());
+        ASSERT_EQUALS(first, second);
+        pool.release(host(), second);
+    }
+
+    TEST_F(ConnectionPoolTest, ConcurrentCheckoutsGetDistinctConnections) {
+        DBClientConnectionPool pool;
+
+        DBClientConnection* first = pool.get(host());
+        DBClientConnection* second = pool.get(host());
+        ASSERT_NOT_EQUALS(first, second);
+        ASSERT_EQUALS(2U, pool.getNumInUseConnections(host()));
+
+        pool.release(host(), first);
+        pool.release(host(), second);
+        ASSERT_EQUALS(2U, pool.getNumAvailableConnections(host()));
+    }
+
+    TEST_F(ConnectionPoolTest, ScopedConnectionReturnedOnDone) {
+        DBClientConnectionPool pool;
+
+        {
+            ScopedDBClientConnection conn(pool, host());
+            ASSERT_EQUALS(1U, pool.getNumInUseConnections(host()));
+            conn.done();
+        }
+
+        ASSERT_EQUALS(0U, pool.getNumInUseConnections(host()));
+        ASSERT_EQUALS(1U, pool.getNumAvailableConnections(host()));
+    }
+
+    TEST_F(ConnectionPoolTest, ScopedConnectionDestroyedWithoutDone) {
+        DBClientConnectionPool pool;
+
+        {
+            ScopedDBClientConnection conn(pool, host());
+        }
+
+        ASSERT_EQUALS(0U, pool.getNumInUseConnections(host()));
+        ASSERT_EQUALS(0U, pool.getNumAvailableConnections(host()));
+    }
+
+    TEST_F(ConnectionPoolTest, CheckoutTimesOutAtMaxPoolSize) {
+        DBClientConnectionPool pool;
+        pool.setMaxPoolSizePerHost(1);
+        pool.setCheckoutTimeoutMillis(10);
+
+        DBClientConnection* conn = pool.get(host());
+        ASSERT_THROWS(pool.get(host()), UserException);
+        ASSERT_EQUALS(1U, pool.getNumInUseConnections(host()));
+
+        pool.release(host(), conn);
+    }
+
+    TEST_F(ConnectionPoolTest, BlockedCheckoutWakesOnRelease) {
+        DBClientConnectionPool pool;
+        pool.setMaxPoolSizePerHost(1);
+
+        DBClientConnection* conn = pool.get(host());
+        boost::thread releaser(boost::bind(&releaseAfterDelay, &pool, host(), conn));
+
+        DBClientConnection* next = pool.get(host());
+        releaser.join();
+
+        ASSERT_EQUALS(conn, next);
+        pool.release(host(), next);
+    }
+
+    TEST_F(ConnectionPoolTest, ReapsIdleConnections) {
+        DBClientConnectionPool pool;
+        pool.setMaxIdleTimeMillis(0);
+
+        pool.release(host(), pool.get(host()));
+        ASSERT_EQUALS(1U, pool.getNumAvailableConnections(host()));
+
+        mongo::sleepmillis(5);
+        pool.reapIdleConnections();
+        ASSERT_EQUALS(0U, pool.getNumAvailableConnections(host()));
+    }
+
+    TEST_F(ConnectionPoolTest, MinPoolSizePreventsReaping) {
+        DBClientConnectionPool pool;
+        pool.setMaxIdleTimeMillis(0);
+        pool.setMinPoolSizePerHost(1);
+
+        DBClientConnection* first = pool.get(host());
+        DBClientConnection* second = pool.get(host());
+        pool.release(host(), first);
+        pool.release(host(), second);
+
+        mongo::sleepmillis(5);
+        pool.reapIdleConnections();
+        ASSERT_EQUALS(1U, pool.getNumAvailableConnections(host()));
+    }
+
+    TEST_F(ConnectionPoolTest, ClearDropsIdleConnections) {
+        DBClientConnectionPool pool;
+
+        DBClientConnection* idle = pool.get(host());
+        DBClientConnection* inUse = pool.get(host());
+        pool.release(host(), idle);
+
+        pool.clear();
+        ASSERT_EQUALS(0U, pool.getNumAvailableConnections(host()));
+        ASSERT_EQUALS(1U, pool.getNumInUseConnections(host()));
+
+        pool.release(host(), inUse);
+    }
+
+    TEST_F(ConnectionPoolTest, FailedConnectDoesNotLeakSlot) {
+        DBClientConnectionPool pool;
+        pool.setMaxPoolSizePerHost(1);
+        pool.setCheckoutTimeoutMillis(10);
+
+        server()->shutdown();
+        ASSERT_THROWS(pool.get(host()), UserException);
+        ASSERT_EQUALS(0U, pool.getNumInUseConnections(host()));
+
+        server()->reboot();
+        pool.release(host(), pool.get(host()));
+    }
+
+} // namespace
@@ -1542,8 +1542,20 @@ namespace mongo {
             return false;
         }
 #endif
+        BSONObjBuilder isMasterCmd;
+        isMasterCmd.append("ismaster", 1);
+        if (!_compressors.empty()) {
+            BSONArrayBuilder compression(isMasterCmd.subarrayStart("compression"));
+            MessageCompressorId id;
+            for (size_t i = 0; i < _compressors.size(); ++i) {
+                if (findMessageCompressor(_compressors[i], &id))
+                    compression.append(_compressors[i]);
+            }
+            compression.doneFast();
+        }
+
         BSONObj info;
-        bool worked = simpleCommand("admin", &info, "ismaster");
+        bool worked = runCommand("admin", isMasterCmd.obj(), info);
         if (worked) {
             if (info.hasField("maxBsonObjectSize"))
                 _maxBsonObjectSize = info.getIntField("maxBsonObjectSize");
@@ -1555,6 +1567,21 @@ namespace mongo {
                 _minWireVersion = info.getIntField("minWireVersion");
             if (info.hasField("maxWireVersion"))
                 _maxWireVersion = info.getIntField("maxWireVersion");
+
+            // The server lists the compressors it accepted, and either side may use any of
+            // them; use the first one that this build supports.
+            if (info["compression"].type() == Array) {
+                BSONObjIterator compressors(info["compression"].Obj());
+                MessageCompressorId id;
+                while (compressors.more()) {
+                    const BSONElement name = compressors.next();
+                    if (name.type() == String &&
+                        findMessageCompressor(name.valueStringData(), &id)) {
+                        p->setCompressor(id);
+                        break;
+                    }
+                }
+            }
         }
 
         return worked;
@@ -1630,6 +1657,14 @@ namespace mongo {
         }
     }
 
+    void DBClientConnection::setCompressors(const std::vector<std::string>& compressors) {
+        _compressors = compressors;
+    }
+
+    MessageCompressionStats DBClientConnection::getCompressionStats() const {
+        return p ? p->compressionStats() : MessageCompressionStats();
+    }
+
     const uint64_t DBClientBase::INVALID_SOCK_CREATION_TIME =
             static_cast<uint64_t>(0xFFFFFFFFFFFFFFFFULL);
 
@@ -1642,11 +1677,17 @@ namespace mongo {
         _maxBsonObjectSize = defaultMaxBsonObjectSize;
         _maxMessageSizeBytes = defaultMaxMessageSizeBytes;
         _maxWriteBatchSize = defaultMaxWriteBatchSize;
+        _maxWriteBatchesInFlight = 1;
     }
 
     DBClientBase::~DBClientBase() {
     }
 
+    void DBClientBase::setMaxWriteBatchesInFlight(int maxBatches) {
+        uassert(0, "maximum write batches in flight must be positive", maxBatches > 0);
+        _maxWriteBatchesInFlight = maxBatches;
+    }
+
     auto_ptr<DBClientCursor> DBClientBase::query(const string &ns, Query query, int nToReturn,
             int nToSkip, const BSONObj *fieldsToReturn, int queryOptions , int batchSize ) {
         auto_ptr<DBClientCursor> c( new DBClientCursor( this,
@@ -1898,6 +1939,20 @@ namespace mongo {
 
     }
 
+    void DBClientBase::_writeOne(
+        const string& ns,
+        WriteOperation* op,
+        const WriteConcern* writeConcern
+    ) {
+        const WriteConcern* operationWriteConcern = writeConcern ? writeConcern : &getWriteConcern();
+
+        WriteResult writeResult;
+        if (getMaxWireVersion() >= 2 && operationWriteConcern->requiresConfirmation())
+            _commandWriter->writeOne( ns, op, operationWriteConcern, &writeResult );
+        else
+            _wireProtocolWriter->writeOne( ns, op, operationWriteConcern, &writeResult );
+    }
+
     namespace {
         struct ScopedWriteOperations {
             ScopedWriteOperations() { }
@@ -1912,9 +1967,12 @@ namespace mongo {
     }
 
     void DBClientBase::insert( const string & ns , BSONObj obj , int flags, const WriteConcern* wc ) {
-        vector<BSONObj> toInsert;
-        toInsert.push_back( obj );
-        insert( ns, toInsert, flags, wc );
+        uassert(0, "document to be inserted exceeds maxBsonObjectSize",
+                obj.objsize() <= getMaxBsonObjectSize());
+
+        // With a single document, continuing on error makes no difference.
+        InsertWriteOperation insert(obj);
+        _writeOne( ns, &insert, wc );
     }
 
     // prefer using the bulk API for this
@@ -1939,13 +1997,10 @@ namespace mongo {
     }
 
     void DBClientBase::remove( const string & ns , Query obj , int flags, const WriteConcern* wc ) {
-        ScopedWriteOperations deletes;
         uassert(0, "remove selector exceeds maxBsonObjectSize",
                 obj.obj.objsize() <= getMaxBsonObjectSize());
-        deletes.enqueue( new DeleteWriteOperation(obj.obj, flags) );
-
-        WriteResult writeResult;
-        _write( ns, deletes.ops, true, wc, &writeResult );
+        DeleteWriteOperation remove(obj.obj, flags);
+        _writeOne( ns, &remove, wc );
     }
 
     void DBClientBase::update( const string & ns , Query query , BSONObj obj , bool upsert, bool multi, const WriteConcern* wc ) {
@@ -1956,15 +2011,12 @@ namespace mongo {
     }
 
     void DBClientBase::update( const string & ns , Query query , BSONObj obj, int flags, const WriteConcern* wc ) {
-        ScopedWriteOperations updates;
         uassert(0, "update selector exceeds maxBsonObjectSize",
                 query.obj.objsize() <= getMaxBsonObjectSize());
         uassert(0, "update document exceeds maxBsonObjectSize",
                 obj.objsize() <= getMaxBsonObjectSize());
-        updates.enqueue( new UpdateWriteOperation(query.obj, obj, flags) );
-
-        WriteResult writeResult;
-        _write( ns, updates.ops, true, wc, &writeResult );
+        UpdateWriteOperation update(query.obj, obj, flags);
+        _writeOne( ns, &update, wc );
     }
 
     BulkOperationBuilder DBClientBase::initializeOrderedBulkOp(const std::string& ns) {
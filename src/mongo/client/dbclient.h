@@ -56,6 +56,7 @@
 
 #include "mongo/client/autolib.h"
 
+#include "mongo/client/connection_pool.h"
 #include "mongo/client/dbclient_rs.h"
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/client/dbclientinterface.h"
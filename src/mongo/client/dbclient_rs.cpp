@@ -172,6 +172,7 @@ namespace {
         if (_lastSlaveOkConn.get() == _master.get()) {
             _lastSlaveOkConn.release();
         }
+        _clearSecondaryConns();
     }
 
     ReplicaSetMonitorPtr DBClientReplicaSet::_getMonitor() const {
@@ -233,6 +234,16 @@ namespace {
             // Don't notify monitor of bg failure, since it's not clear how long ago it happened
         }
 
+        for (SecondaryConnMap::iterator it = _secondaryConns.begin();
+             it != _secondaryConns.end();) {
+            if (it->second->isStillConnected()) {
+                ++it;
+                continue;
+            }
+            delete it->second;
+            _secondaryConns.erase(it++);
+        }
+
         return true;
     }
 
@@ -368,19 +379,6 @@ namespace {
         }
     }
 
-    void DBClientReplicaSet::logoutAll(DBClientConnection* conn) {
-        for (map<string, BSONObj>::const_iterator i = _auths.begin(); i != _auths.end(); ++i) {
-            BSONObj response;
-            try {
-                conn->logout(i->first, response);
-            }
-            catch (const UserException&) {
-                warning() << "Failed to logout: " << conn->getServerAddress() <<
-                    " on db: " << i->first << endl;
-            }
-        }
-    }
-
     DBClientConnection& DBClientReplicaSet::masterConn() {
         return *checkMaster();
     }
@@ -441,6 +439,7 @@ namespace {
                 if ( conn != _master.get() ) {
                     resetMaster();
                 }
+                _clearSecondaryConns();
 
                 return;
             }
@@ -491,6 +490,9 @@ namespace {
                 verify(_lastSlaveOkConn->isFailed());
             }
         }
+
+        // Pooled connections are still logged in; rather than logging each out, drop them.
+        _clearSecondaryConns();
     }
 
     // ------------- simple functions -----------------
@@ -675,7 +677,9 @@ namespace {
         // Failover to next slave
         _getMonitor()->failedHost( _lastSlaveOkHost );
 
+        const HostAndPort host = _lastSlaveOkHost;
         resetSlaveOkConn();
+        _dropSecondaryConn(host);
     }
 
     DBClientConnection* DBClientReplicaSet::selectNodeUsingTags(
@@ -718,6 +722,19 @@ namespace {
             return _master.get();
         }
 
+        // Switching back to a secondary we have used before is a pool checkout.
+        if (DBClientConnection* pooled = _checkoutSecondaryConn(selectedNode)) {
+            _lastSlaveOkConn.reset(pooled);
+            _lastSlaveOkConn->setReplSetClientCallback(this);
+            _lastSlaveOkConn->setRunCommandHook(_runCommandHook);
+            _lastSlaveOkConn->setPostRunCommandHook(_postRunCommandHook);
+
+            LOG( 3 ) << "dbclient_rs selecting pooled connection to node " << selectedNode
+                     << endl;
+
+            return _lastSlaveOkConn.get();
+        }
+
         // Needs to perform a dynamic_cast because we need to set the replSet
         // callback. We should eventually not need this after we remove the
         // callback.
@@ -1018,7 +1035,10 @@ namespace {
          * as failed. For example, asserts 13079, 13080, 16386
          */
         _getMonitor()->failedHost(_lastSlaveOkHost);
+
+        const HostAndPort host = _lastSlaveOkHost;
         resetSlaveOkConn();
+        _dropSecondaryConn(host);
     }
 
     void DBClientReplicaSet::reset() {
@@ -1046,20 +1066,55 @@ namespace {
             _lastSlaveOkConn.release();
         }
         else if (_lastSlaveOkConn.get() != NULL) {
-            if (_authPooledSecondaryConn) {
-                logoutAll(_lastSlaveOkConn.get());
+            if (_lastSlaveOkConn->isFailed() || _lastSlaveOkHost.empty()) {
+                _lastSlaveOkConn.reset();
             }
             else {
-                // Mongos pooled connections are all authenticated with the same credentials;
-                // so no need to logout.
+                // Keep it, still authenticated with everything in _auths, for the next time
+                // this member is selected.
+                _dropSecondaryConn(_lastSlaveOkHost);
+                _secondaryConns[_lastSlaveOkHost] = _lastSlaveOkConn.release();
             }
-
-            _lastSlaveOkConn.reset();
         }
 
         _lastSlaveOkHost = HostAndPort();
     }
 
+    DBClientConnection* DBClientReplicaSet::_checkoutSecondaryConn(const HostAndPort& host) {
+        SecondaryConnMap::iterator it = _secondaryConns.find(host);
+        if (it == _secondaryConns.end())
+            return NULL;
+
+        DBClientConnection* conn = it->second;
+        _secondaryConns.erase(it);
+
+        // checks are ordered from cheap to expensive
+        if (conn->isFailed() || !conn->isStillConnected()) {
+            LOG(1) << "discarding disconnected pooled connection to " << host;
+            delete conn;
+            return NULL;
+        }
+
+        return conn;
+    }
+
+    void DBClientReplicaSet::_dropSecondaryConn(const HostAndPort& host) {
+        SecondaryConnMap::iterator it = _secondaryConns.find(host);
+        if (it == _secondaryConns.end())
+            return;
+
+        delete it->second;
+        _secondaryConns.erase(it);
+    }
+
+    void DBClientReplicaSet::_clearSecondaryConns() {
+        for (SecondaryConnMap::iterator it = _secondaryConns.begin();
+             it != _secondaryConns.end(); ++it) {
+            delete it->second;
+        }
+        _secondaryConns.clear();
+    }
+
     // trying to optimize for the common dont-care-about-tags case.
     static const BSONArray tagsMatchesAll = BSON_ARRAY(BSONObj());
     TagSet::TagSet() : _tags(tagsMatchesAll) {}
@@ -213,12 +213,6 @@ namespace mongo {
 
         void _auth( DBClientConnection * conn );
 
-        /**
-         * Calls logout on the connection for all known database this DBClientRS instance has
-         * logged in.
-         */
-        void logoutAll(DBClientConnection* conn);
-
         /**
          * Clears the master connection.
          */
@@ -229,6 +223,22 @@ namespace mongo {
          */
         void resetSlaveOkConn();
 
+        /**
+         * Takes the pooled connection to 'host' out of the pool. Returns NULL if there is none
+         * or it has since been disconnected.
+         */
+        DBClientConnection* _checkoutSecondaryConn(const HostAndPort& host);
+
+        /**
+         * Destroys the pooled connection to 'host', if there is one.
+         */
+        void _dropSecondaryConn(const HostAndPort& host);
+
+        /**
+         * Destroys all pooled connections, e.g. once their credentials are out of date.
+         */
+        void _clearSecondaryConns();
+
         /**
          * Maximum number of retries to make for auto-retry logic when performing a slave ok
          * operation.
@@ -255,6 +265,12 @@ namespace mongo {
         std::auto_ptr<DBClientConnection> _lastSlaveOkConn;
         boost::shared_ptr<ReadPreferenceSetting> _lastReadPref;
 
+        // Idle, authenticated connections to secondaries, at most one per member, so that
+        // moving the slaveOk connection between members does not mean reconnecting and
+        // reauthenticating each time. Owned here; never includes _master.
+        typedef std::map<HostAndPort, DBClientConnection*> SecondaryConnMap;
+        SecondaryConnMap _secondaryConns;
+
         double _so_timeout;
 
         // we need to store so that when we connect to a new node on failure
@@ -50,6 +50,7 @@ namespace {
     using mongo::BSONField;
     using mongo::BSONObj;
     using mongo::ConnectionString;
+    using mongo::DBClientBase;
     using mongo::DBClientCursor;
     using mongo::DBClientReplicaSet;
     using mongo::HostAndPort;
@@ -491,6 +492,96 @@ namespace {
         boost::scoped_ptr<MockReplicaSet> _replSet;
     };
 
+    /**
+     * Counts the connections made to each host through another hook.
+     */
+    class CountingConnectionHook : public ConnectionString::ConnectionHook {
+    public:
+        explicit CountingConnectionHook(ConnectionString::ConnectionHook* hook)
+            : _hook(hook) {}
+
+        virtual DBClientBase* connect(const ConnectionString& c,
+                                      string& errmsg,
+                                      double socketTimeout) {
+            ++_counts[c.toString()];
+            return _hook->connect(c, errmsg, socketTimeout);
+        }
+
+        int getCount(const string& host) {
+            return _counts[host];
+        }
+
+    private:
+        ConnectionString::ConnectionHook* const _hook;
+        map<string, int> _counts;
+    };
+
+    string queryNodeWithTag(DBClientReplicaSet* replConn, const string& dc) {
+        Query query;
+        query.readPref(mongo::ReadPreference_SecondaryOnly, BSON_ARRAY(BSON("dc" << dc)));
+
+        // Note: IdentityNS contains the name of the server.
+        auto_ptr<DBClientCursor> cursor = replConn->query(IdentityNS, query);
+        BSONObj doc = cursor->next();
+        return doc[HostField.name()].str();
+    }
+
+    TEST_F(TaggedFiveMemberRS, SwitchingSecondariesReusesConnections) {
+        MockReplicaSet* replSet = getReplSet();
+        vector<HostAndPort> seedList;
+        seedList.push_back(HostAndPort(replSet->getPrimary()));
+
+        DBClientReplicaSet replConn(replSet->getSetName(), seedList);
+
+        // Need up-to-date view to ensure both tagged secondaries are known.
+        ReplicaSetMonitor::get(replSet->getSetName())->startOrContinueRefresh().refreshAll();
+
+        CountingConnectionHook counter(mongo::MockConnRegistry::get()->getConnStrHook());
+        ConnectionString::setConnectionHook(&counter);
+
+        const string sf = queryNodeWithTag(&replConn, "sf");
+        const string ma = queryNodeWithTag(&replConn, "ma");
+        ASSERT_NOT_EQUALS(sf, ma);
+
+        ASSERT_EQUALS(sf, queryNodeWithTag(&replConn, "sf"));
+        ASSERT_EQUALS(ma, queryNodeWithTag(&replConn, "ma"));
+        ASSERT_EQUALS(sf, queryNodeWithTag(&replConn, "sf"));
+
+        ConnectionString::setConnectionHook(mongo::MockConnRegistry::get()->getConnStrHook());
+
+        ASSERT_EQUALS(1, counter.getCount(sf));
+        ASSERT_EQUALS(1, counter.getCount(ma));
+    }
+
+    TEST_F(TaggedFiveMemberRS, FailedSecondaryIsNotReused) {
+        MockReplicaSet* replSet = getReplSet();
+        vector<HostAndPort> seedList;
+        seedList.push_back(HostAndPort(replSet->getPrimary()));
+
+        DBClientReplicaSet replConn(replSet->getSetName(), seedList);
+        ReplicaSetMonitor::get(replSet->getSetName())->startOrContinueRefresh().refreshAll();
+
+        CountingConnectionHook counter(mongo::MockConnRegistry::get()->getConnStrHook());
+        ConnectionString::setConnectionHook(&counter);
+
+        const string sf = queryNodeWithTag(&replConn, "sf");
+        queryNodeWithTag(&replConn, "ma");
+
+        // Take the pooled connection down with the node, then bring the node back.
+        replSet->kill(sf);
+        replSet->restore(sf);
+        ReplicaSetMonitor::get(replSet->getSetName())->startOrContinueRefresh().refreshAll();
+        const int connectsBefore = counter.getCount(sf);
+
+        ASSERT_EQUALS(sf, queryNodeWithTag(&replConn, "sf"));
+
+        ConnectionString::setConnectionHook(mongo::MockConnRegistry::get()->getConnStrHook());
+
+        // The monitor may also have connected while failing over, so only check that the
+        // read did not go through the stale connection.
+        ASSERT_GREATER_THAN(counter.getCount(sf), connectsBefore);
+    }
+
     TEST_F(TaggedFiveMemberRS, ConnShouldPinIfSameSettings) {
         MockReplicaSet* replSet = getReplSet();
         vector<HostAndPort> seedList;
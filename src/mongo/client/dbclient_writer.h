@@ -24,6 +24,13 @@ namespace mongo {
     class WriteConcern;
     class WriteResult;
 
+    // Operations whose incrementalSize() plus kWriteBatchOperationOverhead each add up to no
+    // more than maxBsonObjectSize less kWriteBatchOverhead are sent by either writer as a
+    // single batch. The overheads cover each operation's array index in a write command and
+    // the command around the operations.
+    const int kWriteBatchOverhead = 16 * 1024;
+    const int kWriteBatchOperationOverhead = 8;
+
     class DBClientWriter {
     public:
         virtual ~DBClientWriter() {};
@@ -37,6 +44,16 @@ namespace mongo {
             const WriteConcern* writeConcern,
             WriteResult* writeResult
         ) = 0;
+
+        // Writes a single operation, as write() would with a vector holding only 'op'. The
+        // request is built in a buffer the writer keeps between calls, so that in the common
+        // case a single write allocates nothing beyond what the network layer needs.
+        virtual void writeOne(
+            const std::string& ns,
+            WriteOperation* op,
+            const WriteConcern* writeConcern,
+            WriteResult* writeResult
+        ) = 0;
     };
 
 } // namespace mongo
@@ -26,6 +26,7 @@
 #include "mongo/util/debug_util.h"
 #include "mongo/client/dbclientcursorshim.h"
 #include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
@@ -48,7 +49,10 @@ namespace mongo {
         resultFlags(0),
         cursorId(),
         _ownCursor( true ),
-        wasError( false ) {
+        wasError( false ),
+        _prefetchLowWaterMark(-1),
+        _prefetchPending(false),
+        _prefetchRequestId(0) {
         _finishConsInit();
     }
 
@@ -64,7 +68,10 @@ namespace mongo {
         resultFlags(0),
         cursorId(_cursorId),
         _ownCursor(true),
-        wasError(false) {
+        wasError(false),
+        _prefetchLowWaterMark(-1),
+        _prefetchPending(false),
+        _prefetchRequestId(0) {
         _finishConsInit();
     }
 
@@ -76,7 +83,9 @@ namespace mongo {
 
     int DBClientCursor::nextBatchSize() {
         if (nToReturn) {
-            int remaining = nToReturn - nReturned;
+            // Documents still buffered in the current batch count against the limit too; a
+            // prefetched getMore is sent before they have been returned.
+            int remaining = nToReturn - nReturned - (batch.nReturned - batch.pos);
 
             if (batchSize && batchSize < remaining)
                 return batchSize;
@@ -178,6 +187,52 @@ namespace mongo {
     void DBClientCursor::requestMore() {
         verify( cursorId && batch.pos == batch.nReturned );
 
+        auto_ptr<Message> response(new Message());
+
+        if ( _prefetchPending ) {
+            _recvPrefetched( *response );
+        }
+        else {
+            BufBuilder b;
+            b.appendNum(opts);
+            b.appendStr(ns);
+            b.appendNum(nextBatchSize());
+            b.appendNum(cursorId);
+
+            Message toSend;
+            toSend.setData(dbGetMore, b.buf(), b.len());
+
+            _client->call( toSend, *response );
+        }
+
+        this->batch.m = response;
+        dataReceived();
+    }
+
+    void DBClientCursor::enablePrefetch(int lowWaterMark) {
+        uassert(0, "prefetch low-water mark must not be negative", lowWaterMark >= 0);
+        _prefetchLowWaterMark = lowWaterMark;
+    }
+
+    void DBClientCursor::_prefetchMore() {
+        if ( _prefetchLowWaterMark < 0 || _prefetchPending || cursorId == 0 )
+            return;
+
+        // the server pushes exhaust batches unasked
+        if ( opts & QueryOption_Exhaust )
+            return;
+
+        const int buffered = batch.nReturned - batch.pos;
+        if ( buffered > _prefetchLowWaterMark )
+            return;
+
+        // nothing more needed if what we have covers the limit
+        if ( nToReturn && nReturned + buffered >= nToReturn )
+            return;
+
+        if ( !_client->lazySupported() )
+            return;
+
         BufBuilder b;
         b.appendNum(opts);
         b.appendStr(ns);
@@ -186,11 +241,25 @@ namespace mongo {
 
         Message toSend;
         toSend.setData(dbGetMore, b.buf(), b.len());
-        auto_ptr<Message> response(new Message());
 
-        _client->call( toSend, *response );
-        this->batch.m = response;
-        dataReceived();
+        _client->say( toSend );
+        _prefetchPending = true;
+        _prefetchRequestId = toSend.header().getId();
+    }
+
+    void DBClientCursor::_recvPrefetched( Message& response ) {
+        verify( _prefetchPending );
+        _prefetchPending = false;
+
+        if ( !_client->recv( response ) ) {
+            uasserted( 0, str::stream() << "recv failed while reading prefetched batch from "
+                                        << _client->getServerAddress() );
+        }
+
+        uassert( 0, str::stream() << "prefetched getMore got a reply to request "
+                                  << response.header().getResponseTo() << " instead of "
+                                  << _prefetchRequestId,
+                 response.header().getResponseTo() == _prefetchRequestId );
     }
 
     /** with QueryOption_Exhaust, the server just blasts data at us (marked at end with cursorid==0). */
@@ -246,13 +315,16 @@ namespace mongo {
         if (nToReturn && nReturned >= nToReturn)
             return false;
 
-        if ( batch.pos < batch.nReturned )
+        if ( batch.pos < batch.nReturned ) {
+            _prefetchMore();
             return true;
+        }
 
         if ( cursorId == 0 )
             return false;
 
         requestMore();
+        _prefetchMore();
         return batch.pos < batch.nReturned;
     }
 
@@ -277,6 +349,7 @@ namespace mongo {
         BSONObj o(batch.data);
         batch.data += o.objsize();
         /* todo would be good to make data null at end of batch for safety */
+        _prefetchMore();
         return o;
     }
 
@@ -355,6 +428,16 @@ namespace mongo {
     DBClientCursor::~DBClientCursor() {
         DESTRUCTOR_GUARD (
 
+        if ( _prefetchPending ) {
+            // the reply is next on the connection, so it has to be read before anything else
+            // is; it also says whether the cursor is still open
+            Message response;
+            _recvPrefetched( response );
+            QueryResult::View qr = response.singleData().view2ptr();
+            if ( !( opts & QueryOption_CursorTailable ) || qr.getCursorId() == 0 )
+                cursorId = qr.getCursorId();
+        }
+
         if ( cursorId && _ownCursor ) {
             BufBuilder b;
             b.appendNum( (int)0 ); // reserved
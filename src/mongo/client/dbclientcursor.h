@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <limits>
 #include <stack>
 
 #include "mongo/client/dbclientinterface.h"
@@ -126,6 +127,19 @@ namespace mongo {
         /// Change batchSize after construction. Can change after requesting first batch.
         void setBatchSize(int newBatchSize) { batchSize = newBatchSize; }
 
+        /**
+         * Turns on prefetching. Once no more than 'lowWaterMark' documents are left unread in
+         * the current batch, the getMore for the next batch is sent right away. Its reply is
+         * read off the connection only when the current batch runs out, so the round trip
+         * overlaps with processing what is already here. The default low-water mark sends the
+         * getMore as soon as each batch arrives.
+         *
+         * While a prefetched getMore is outstanding, its reply is the next thing on the
+         * connection, so nothing else may use the connection until the cursor is exhausted or
+         * destroyed. Has no effect on exhaust cursors or connections without lazy support.
+         */
+        void enablePrefetch(int lowWaterMark = std::numeric_limits<int>::max());
+
         DBClientCursor( DBClientBase* client, const std::string &_ns, BSONObj _query, int _nToReturn,
                         int _nToSkip, const BSONObj *_fieldsToReturn, int queryOptions , int bs );
         DBClientCursor( DBClientBase* client, const std::string &_ns, long long _cursorId, int _nToReturn, int options, int _batchSize );
@@ -207,12 +221,20 @@ namespace mongo {
         std::string _scopedHost;
         std::string _lazyHost;
         bool wasError;
+        int _prefetchLowWaterMark; // negative when prefetching is off
+        bool _prefetchPending; // a getMore has been sent but its reply not yet read
+        MSGID _prefetchRequestId;
 
         void dataReceived() { bool retry; std::string lazyHost; dataReceived( retry, lazyHost ); }
         void dataReceived( bool& retry, std::string& lazyHost );
         void requestMore();
         void exhaustReceiveMore(); // for exhaust
 
+        // Sends the next getMore ahead of time if prefetching calls for it.
+        void _prefetchMore();
+        // Reads the reply to the outstanding prefetched getMore into 'response'.
+        void _recvPrefetched(Message& response);
+
         // Don't call from a virtual function
         void _assertIfNull() const { uassert(13348, "connection died", this); }
 
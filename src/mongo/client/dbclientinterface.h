@@ -1318,6 +1318,7 @@ namespace mongo {
      */
     class MONGO_CLIENT_API DBClientBase : public DBClientWithCommands, public DBConnector {
     friend class BulkOperationBuilder;
+    friend class StreamingBulkWriter;
     protected:
         static AtomicInt64 ConnectionIdSequence;
         long long _connectionId; // unique connection id for this connection
@@ -1327,6 +1328,7 @@ namespace mongo {
         int _maxBsonObjectSize;
         int _maxMessageSizeBytes;
         int _maxWriteBatchSize;
+        int _maxWriteBatchesInFlight;
         void _write(
             const std::string& ns,
             const std::vector<WriteOperation*>& writes,
@@ -1334,6 +1336,13 @@ namespace mongo {
             const WriteConcern* writeConcern,
             WriteResult* writeResult
         );
+        // Writes a single operation without the batching machinery of _write, for the single
+        // document insert, update and remove.
+        void _writeOne(
+            const std::string& ns,
+            WriteOperation* op,
+            const WriteConcern* writeConcern
+        );
     public:
         static const uint64_t INVALID_SOCK_CREATION_TIME;
 
@@ -1359,6 +1368,18 @@ namespace mongo {
         int getMaxMessageSizeBytes() { return _maxMessageSizeBytes; }
         int getMaxWriteBatchSize() { return _maxWriteBatchSize; }
 
+        /**
+         * The number of write command batches an unordered bulk write may have outstanding on
+         * this connection. With more than one, the next batch is sent before the reply to the
+         * previous one has arrived, which hides network latency on large unordered writes.
+         * Ordered writes, unacknowledged writes and replica set connections always send one
+         * batch at a time.
+         *
+         * Default: 1
+         */
+        void setMaxWriteBatchesInFlight(int maxBatches);
+        int getMaxWriteBatchesInFlight() const { return _maxWriteBatchesInFlight; }
+
         /** send a query to the database.
          @param ns namespace to query, format is <dbname>.<collectname>[.<collectname>]*
          @param query query to perform on the collection.  this is a BSONObj (binary JSON)
@@ -1663,6 +1684,24 @@ namespace mongo {
 
         uint64_t getSockCreationMicroSec() const;
 
+        /**
+         * Asks the server, when connecting, to compress the messages sent each way with the
+         * first of 'compressors' both sides support, such as "zlib". This trades CPU time for
+         * bandwidth, which pays off on slow links. Names this build does not support are
+         * ignored; see supportedMessageCompressors(). Takes effect from the next connect or
+         * reconnect.
+         *
+         * Default: no compression
+         */
+        void setCompressors(const std::vector<std::string>& compressors);
+        const std::vector<std::string>& getCompressors() const { return _compressors; }
+
+        /**
+         * @return the number of bytes sent and received compressed since the connection was
+         * last made, and what they would have been uncompressed.
+         */
+        MessageCompressionStats getCompressionStats() const;
+
     protected:
         virtual void _auth(const BSONObj& params);
         virtual void sayPiggyBack( Message &toSend );
@@ -1683,6 +1722,7 @@ namespace mongo {
 
         std::map<std::string, BSONObj> authCache;
         double _so_timeout;
+        std::vector<std::string> _compressors;
         bool _connect( std::string& errmsg );
 
         static AtomicInt32 _numConnections;
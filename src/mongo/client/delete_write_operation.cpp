@@ -57,14 +57,18 @@ namespace mongo {
         _selector.appendSelfToBufBuilder(*builder);
     }
 
+    const BSONObj* DeleteWriteOperation::requestDocument() const {
+        return &_selector;
+    }
+
     void DeleteWriteOperation::startCommand(const std::string& ns, BSONObjBuilder* command) const {
         command->append(kCommandKey, nsToCollectionSubstring(ns));
     }
 
     void DeleteWriteOperation::appendSelfToCommand(BSONArrayBuilder* batch) const {
-        BSONObjBuilder updateBuilder;
+        BSONObjBuilder updateBuilder(batch->subobjStart());
         appendSelfToBSONObj(&updateBuilder);
-        batch->append(updateBuilder.obj());
+        updateBuilder.doneFast();
     }
 
     void DeleteWriteOperation::appendSelfToBSONObj(BSONObjBuilder* obj) const {
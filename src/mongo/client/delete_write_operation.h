@@ -29,6 +29,7 @@ namespace mongo {
 
         virtual void startRequest(const std::string& ns, bool ordered, BufBuilder* builder) const;
         virtual void appendSelfToRequest(BufBuilder* builder) const;
+        virtual const BSONObj* requestDocument() const;
 
         virtual void startCommand(const std::string& ns, BSONObjBuilder* command) const;
         virtual void appendSelfToCommand(BSONArrayBuilder* request) const;
@@ -20,7 +20,9 @@
 #include "mongo/client/gridfs.h"
 
 #include <algorithm>
+#include <boost/bind.hpp>
 #include <boost/smart_ptr.hpp>
+#include <boost/thread/thread.hpp>
 #include <fcntl.h>
 #include <fstream>
 #include <utility>
@@ -29,7 +31,11 @@
 #include <io.h>
 #endif
 
+#include "mongo/client/connection_pool.h"
+#include "mongo/client/dbclient_writer.h"
 #include "mongo/client/dbclientcursor.h"
+#include "mongo/client/insert_write_operation.h"
+#include "mongo/util/md5.hpp"
 
 #ifndef MIN
 #define MIN(a,b) ( (a) < (b) ? (a) : (b) )
@@ -44,10 +50,136 @@ namespace mongo {
     using std::ios;
     using std::ofstream;
     using std::ostream;
+    using std::streamoff;
     using std::string;
 
     const unsigned DEFAULT_CHUNK_SIZE = 255 * 1024;
 
+    namespace {
+        // Writes chunks [begin, end) of 'file' at their offset in the already created file
+        // 'where'. Errors are reported through 'error' since this runs on its own thread.
+        void writeChunkRange( const GridFile* file , DBClientConnectionPool* pool ,
+                              const HostAndPort* host , const string* where ,
+                              int begin , int end , string* error ) {
+            try {
+                ScopedDBClientConnection conn( *pool , *host );
+
+                std::fstream out( where->c_str() , ios::in | ios::out | ios::binary );
+                uassert( 13325 , "couldn't open file: " + *where , out.is_open() );
+                out.seekp( static_cast<streamoff>( begin ) * file->getChunkSize() );
+
+                GridFileReader reader( *file , conn.get() , begin , end );
+                while ( reader.more() ) {
+                    int len;
+                    const char* data = reader.next().data( len );
+                    out.write( data , len );
+                }
+
+                out.flush();
+                uassert( 0 , "error writing file: " + *where , out.good() );
+                conn.done();
+            }
+            catch ( const DBException& e ) {
+                *error = e.toString();
+            }
+            catch ( const std::exception& e ) {
+                *error = e.what();
+            }
+        }
+    } // namespace
+
+    /**
+     * Buffers the chunks of one file and inserts them with unordered multi document inserts,
+     * which the connection splits into write batches and pipelines according to
+     * DBClientBase::setMaxWriteBatchesInFlight. Also computes the file's md5 if the GridFS
+     * did so on the client when the file was started.
+     */
+    class GridFS::ChunkWriter {
+        MONGO_DISALLOW_COPYING(ChunkWriter);
+    public:
+        ChunkWriter( GridFS* grid , const OID& id )
+            : _grid( grid )
+            , _idObj( BSON( "_id" << id ) )
+            , _clientMD5( grid->_clientMD5 )
+            , _nextChunk( 0 )
+            , _numBatches( 1 )
+            , _batchBytes( 0 )
+            , _batchChunks( 0 )
+            , _maxBatches( std::max( 1 , grid->_client.getMaxWriteBatchesInFlight() ) )
+            , _maxBatchBytes( grid->_client.getMaxBsonObjectSize() - kWriteBatchOverhead )
+            , _maxBatchChunks( grid->_client.getMaxWriteBatchSize() ) {
+            md5_init( &_md5 );
+        }
+
+        void append( const char* data , int len ) {
+            if ( _clientMD5 )
+                md5_append( &_md5 , reinterpret_cast<const md5_byte_t*>( data ) , len );
+
+            GridFSChunk c( _idObj , _nextChunk++ , data , len );
+            const int size = InsertWriteOperation( c._data ).incrementalSize() +
+                             kWriteBatchOperationOverhead;
+
+            // Insert what is buffered first if this chunk would not fit in the batches that
+            // may be in flight at once, so that no insert ends with a batch left part full.
+            if ( _batchChunks == _maxBatchChunks || _batchBytes + size > _maxBatchBytes ) {
+                if ( _numBatches == _maxBatches )
+                    flush();
+                else if ( _batchChunks > 0 ) {
+                    ++_numBatches;
+                    _batchBytes = 0;
+                    _batchChunks = 0;
+                }
+            }
+
+            _buffered.push_back( c._data );
+            _batchBytes += size;
+            ++_batchChunks;
+        }
+
+        void flush() {
+            if ( _buffered.empty() )
+                return;
+
+            _grid->_client.insert( _grid->_chunksNS , _buffered , InsertOption_ContinueOnError );
+            _buffered.clear();
+            _numBatches = 1;
+            _batchBytes = 0;
+            _batchChunks = 0;
+        }
+
+        /**
+         * Inserts any buffered chunks.
+         * @return the md5 of the file, or an empty string if the server is to compute it
+         */
+        string finish() {
+            flush();
+            if ( ! _clientMD5 )
+                return "";
+
+            md5digest digest;
+            md5_finish( &_md5 , digest );
+            return digestToString( digest );
+        }
+
+    private:
+        GridFS* const _grid;
+        const BSONObj _idObj;
+        const bool _clientMD5;
+        int _nextChunk;
+        std::vector<BSONObj> _buffered;
+
+        // The batches the connection will split the buffered chunks into, the last of which
+        // is being filled.
+        int _numBatches;
+        int _batchBytes;
+        int _batchChunks;
+
+        const int _maxBatches;
+        const int _maxBatchBytes;
+        const int _maxBatchChunks;
+        md5_state_t _md5;
+    };
+
     GridFSChunk::GridFSChunk( BSONObj o ) {
         _data = o;
     }
@@ -65,6 +197,8 @@ namespace mongo {
         _filesNS = dbName + "." + prefix + ".files";
         _chunksNS = dbName + "." + prefix + ".chunks";
         _chunkSize = DEFAULT_CHUNK_SIZE;
+        _readBatchSize = 0;
+        _clientMD5 = false;
 
         client.createIndex( _filesNS , BSON( "filename" << 1 ) );
         client.createIndex( _chunksNS , IndexSpec().addKeys(BSON( "files_id" << 1 << "n" << 1 )).unique() );
@@ -83,24 +217,37 @@ namespace mongo {
         return _chunkSize;
     }
 
+    void GridFS::setReadBatchSize(int chunks) {
+        massert( 0 , "invalid read batch size is specified", (chunks >= 0 ));
+        _readBatchSize = chunks;
+    }
+
+    int GridFS::getReadBatchSize() const {
+        return _readBatchSize;
+    }
+
+    void GridFS::setClientMD5(bool enabled) {
+        _clientMD5 = enabled;
+    }
+
+    bool GridFS::getClientMD5() const {
+        return _clientMD5;
+    }
+
     BSONObj GridFS::storeFile( const char* data , size_t length , const string& remoteName , const string& contentType) {
         char const * const end = data + length;
 
         OID id;
         id.init();
-        BSONObj idObj = BSON("_id" << id);
+        ChunkWriter chunks(this, id);
 
-        int chunkNumber = 0;
         while (data < end) {
             int chunkLen = MIN(_chunkSize, (unsigned)(end-data));
-            GridFSChunk c(idObj, chunkNumber, data, chunkLen);
-            _client.insert( _chunksNS.c_str() , c._data );
-
-            chunkNumber++;
+            chunks.append(data, chunkLen);
             data += chunkLen;
         }
 
-        return insertFile(remoteName, id, length, contentType);
+        return insertFile(remoteName, id, length, contentType, chunks.finish());
     }
 
 
@@ -114,14 +261,12 @@ namespace mongo {
 
         OID id;
         id.init();
-        BSONObj idObj = BSON("_id" << id);
+        ChunkWriter chunks(this, id);
 
-        int chunkNumber = 0;
+        boost::scoped_array<char> buf(new char[_chunkSize]);
         gridfs_offset length = 0;
         while (!feof(fd)) {
-            //boost::scoped_array<char>buf (new char[_chunkSize+1]);
-            char * buf = new char[_chunkSize+1];
-            char* bufPos = buf;//.get();
+            char* bufPos = buf.get();
             unsigned int chunkLen = 0; // how much in the chunk now
             while(chunkLen != _chunkSize && !feof(fd)) {
                 int readLen = fread(bufPos, 1, _chunkSize - chunkLen, fd);
@@ -131,21 +276,17 @@ namespace mongo {
                 verify(chunkLen <= _chunkSize);
             }
 
-            GridFSChunk c(idObj, chunkNumber, buf, chunkLen);
-            _client.insert( _chunksNS.c_str() , c._data );
-
+            chunks.append(buf.get(), chunkLen);
             length += chunkLen;
-            chunkNumber++;
-            delete[] buf;
         }
 
         if (fd != stdin)
             fclose( fd );
 
-        return insertFile((remoteName.empty() ? fileName : remoteName), id, length, contentType);
+        return insertFile((remoteName.empty() ? fileName : remoteName), id, length, contentType, chunks.finish());
     }
 
-    BSONObj GridFS::insertFile(const string& name, const OID& id, gridfs_offset length, const string& contentType) {
+    BSONObj GridFS::insertFile(const string& name, const OID& id, gridfs_offset length, const string& contentType, const string& md5) {
         // Wait for any pending writebacks to finish
         BSONObj errObj = _client.getLastErrorDetailed();
         uassert( 16428,
@@ -153,18 +294,23 @@ namespace mongo {
                                << ", error: " << errObj,
                  DBClientWithCommands::getLastErrorString(errObj) == "" );
 
-        BSONObj res;
-        if ( ! _client.runCommand( _dbName.c_str() , BSON( "filemd5" << id << "root" << _prefix ) , res ) )
-            throw UserException( 9008 , "filemd5 failed" );
-
         BSONObjBuilder file;
         file << "_id" << id
              << "filename" << name
              << "chunkSize" << _chunkSize
              << "uploadDate" << DATENOW
-             << "md5" << res["md5"]
              ;
 
+        if (md5.empty()) {
+            BSONObj res;
+            if ( ! _client.runCommand( _dbName.c_str() , BSON( "filemd5" << id << "root" << _prefix ) , res ) )
+                throw UserException( 9008 , "filemd5 failed" );
+            file << "md5" << res["md5"];
+        }
+        else {
+            file << "md5" << md5;
+        }
+
         if (length < 1024*1024*1024) { // 2^30
             file << "length" << (int) length;
         }
@@ -213,10 +359,6 @@ namespace mongo {
         return _client.query( _filesNS.c_str() , o );
     }
 
-    void GridFS::_insertChunk( const GridFSChunk& chunk ) {
-        _client.insert( _chunksNS.c_str() , chunk._data );
-    }
-
     BSONObj GridFile::getMetadata() const {
         BSONElement meta_element = _obj["metadata"];
         if( meta_element.eoo() ) {
@@ -240,13 +382,10 @@ namespace mongo {
     gridfs_offset GridFile::write( ostream & out ) const {
         _exists();
 
-        const int num = getNumChunks();
-
-        for ( int i=0; i<num; i++ ) {
-            GridFSChunk c = getChunk( i );
-
+        GridFileReader reader( *this );
+        while ( reader.more() ) {
             int len;
-            const char * data = c.data( len );
+            const char * data = reader.next().data( len );
             out.write( data , len );
         }
 
@@ -264,19 +403,132 @@ namespace mongo {
         }
     }
 
+    gridfs_offset GridFile::writeParallel( const string& where ,
+                                           DBClientConnectionPool& pool ,
+                                           const HostAndPort& host ,
+                                           int numStreams ) const {
+        _exists();
+        massert( 0 , "invalid number of streams is specified" , numStreams > 0 );
+
+        {
+            // Create or truncate the file so each stream can open it for update and seek.
+            ofstream out( where.c_str() , ios::out | ios::binary | ios::trunc );
+            uassert( 13325 , "couldn't open file: " + where , out.is_open() );
+        }
+
+        const int numChunks = getNumChunks();
+        numStreams = min( numStreams , numChunks );
+
+        std::vector<string> errors( numStreams );
+        boost::thread_group streams;
+        for ( int i = 0; i < numStreams; i++ ) {
+            const int begin = static_cast<int>( (long long)numChunks * i / numStreams );
+            const int end = static_cast<int>( (long long)numChunks * (i + 1) / numStreams );
+            streams.create_thread( boost::bind( &writeChunkRange , this , &pool , &host ,
+                                                &where , begin , end , &errors[i] ) );
+        }
+        streams.join_all();
+
+        for ( int i = 0; i < numStreams; i++ ) {
+            uassert( 0 , "error writing GridFS file " + getFilename() + ": " + errors[i] ,
+                     errors[i].empty() );
+        }
+
+        return getContentLength();
+    }
+
     void GridFile::_exists() const {
         uassert( 10015 ,  "doesn't exists" , exists() );
     }
+
+    GridFileReader::GridFileReader( const GridFile& file )
+        : _endChunk( file.getNumChunks() )
+        , _nextChunk( 0 ) {
+        _init( file , &file._grid->_client );
+    }
+
+    GridFileReader::GridFileReader( const GridFile& file , DBClientBase* client ,
+                                    int beginChunk , int endChunk )
+        : _endChunk( endChunk )
+        , _nextChunk( beginChunk ) {
+        _init( file , client );
+    }
+
+    GridFileReader::~GridFileReader() {
+    }
+
+    void GridFileReader::_init( const GridFile& file , DBClientBase* client ) {
+        file._exists();
+
+        BSONObjBuilder b;
+        b.appendAs( file._obj["_id"] , "files_id" );
+        b.append( "n" , BSON( "$gte" << _nextChunk << "$lt" << _endChunk ) );
+
+        // The { files_id : 1 , n : 1 } index created by GridFS serves both the range and
+        // the sort.
+        const GridFS* grid = file._grid;
+        _cursor = client->query( grid->_chunksNS , Query( b.obj() ).sort( BSON( "n" << 1 ) ) ,
+                                 0 , 0 , NULL , 0 , grid->_readBatchSize );
+        uassert( 0 , "error querying chunks of GridFS file " + file.getFilename() ,
+                 _cursor.get() );
+    }
+
+    bool GridFileReader::more() {
+        if ( _nextChunk == _endChunk )
+            return false;
+
+        uassert( 10014 , str::stream() << "chunk " << _nextChunk << " is missing" ,
+                 _cursor->more() );
+        return true;
+    }
+
+    GridFSChunk GridFileReader::next() {
+        uassert( 0 , "no more chunks to read" , more() );
+
+        BSONObj o = _cursor->nextSafe();
+        uassert( 10014 , str::stream() << "chunk " << _nextChunk << " is missing" ,
+                 o["n"].numberInt() == _nextChunk );
+
+        _nextChunk++;
+        return GridFSChunk( o );
+    }
+
+    GridFileInputStream::GridFileInputStream( const GridFile& file )
+        : std::istream( NULL )
+        , _buf( file ) {
+        rdbuf( &_buf );
+    }
+
+    GridFileInputStream::StreamBuf::StreamBuf( const GridFile& file )
+        : _reader( file )
+        , _chunk( BSONObj() ) {
+    }
+
+    GridFileInputStream::StreamBuf::int_type GridFileInputStream::StreamBuf::underflow() {
+        while ( gptr() == egptr() ) {
+            if ( ! _reader.more() )
+                return traits_type::eof();
+
+            _chunk = _reader.next();
+
+            int len;
+            char* data = const_cast<char*>( _chunk.data( len ) );
+            setg( data , data , data + len );
+        }
+        return traits_type::to_int_type( *gptr() );
+    }
     
     GridFileBuilder::GridFileBuilder( GridFS* const grid ) :
         _grid( grid ),
         _chunkSize( grid->getChunkSize() ),
-        _currentChunk( 0 ),
         _pendingData( new char[_chunkSize] ),
         _pendingDataSize( 0 ),
         _fileLength( 0 ) {
         _fileId.init();
-        _fileIdObj = BSON( "_id" << _fileId );
+        _chunkWriter.reset( new GridFS::ChunkWriter( _grid, _fileId ) );
+    }
+
+    GridFileBuilder::~GridFileBuilder() {
     }
     
     const char* GridFileBuilder::_appendChunk( const char* data,
@@ -289,9 +541,7 @@ namespace mongo {
             // necessary
             if ((chunkLen < _chunkSize) && (!forcePendingInsert))
                 break;
-            GridFSChunk chunk( _fileIdObj, _currentChunk, data, chunkLen );
-            _grid->_insertChunk( chunk );
-            ++_currentChunk;
+            _chunkWriter->append( data, chunkLen );
             data += chunkLen;
             _fileLength += chunkLen;
         }
@@ -339,13 +589,12 @@ namespace mongo {
                                         const string& contentType ) {
         _appendPendingData();
         BSONObj ret = _grid->insertFile( remoteName, _fileId, _fileLength,
-                                         contentType );
+                                         contentType, _chunkWriter->finish() );
         // resets the object to allow more data append for a GridFile
-        _currentChunk = 0;
         _pendingDataSize = 0;
         _fileLength = 0;
         _fileId.init();
-        _fileIdObj = BSON( "_id" << _fileId );
+        _chunkWriter.reset( new GridFS::ChunkWriter( _grid, _fileId ) );
         return ret;
     }
     
@@ -18,7 +18,12 @@
 #pragma once
 
 #include "boost/scoped_array.hpp"
+#include "boost/scoped_ptr.hpp"
 
+#include <istream>
+#include <streambuf>
+
+#include "mongo/base/disallow_copying.h"
 #include "mongo/bson/bsonelement.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/client/dbclientinterface.h"
@@ -28,9 +33,11 @@ namespace mongo {
 
     typedef unsigned long long gridfs_offset;
 
+    class DBClientConnectionPool;
     class GridFS;
     class GridFile;
     class GridFileBuilder;
+    class GridFileReader;
 
     class MONGO_CLIENT_API GridFSChunk {
     public:
@@ -74,6 +81,26 @@ namespace mongo {
 
         unsigned int getChunkSize() const;
 
+        /**
+         * The number of chunks requested per round trip when reading a file, which is also
+         * how far a reader runs ahead of its consumer. Zero leaves the choice to the server.
+         */
+        void setReadBatchSize(int chunks);
+
+        int getReadBatchSize() const;
+
+        /**
+         * If enabled, the md5 of a stored file is computed by the client as its chunks are
+         * written, instead of by the filemd5 command, which rereads every chunk on the server
+         * once the file is complete. A file already being written, such as by a
+         * GridFileBuilder, keeps the setting it was started with.
+         *
+         * Default: false
+         */
+        void setClientMD5(bool enabled);
+
+        bool getClientMD5() const;
+
         /**
          * puts the file reference by fileName into the db
          * @param fileName local filename relative to process
@@ -130,16 +157,20 @@ namespace mongo {
         std::string _filesNS;
         std::string _chunksNS;
         unsigned int _chunkSize;
+        int _readBatchSize;
+        bool _clientMD5;
 
-        // insert fileobject. All chunks must be in DB.
-        BSONObj insertFile(const std::string& name, const OID& id, gridfs_offset length, const std::string& contentType);
+        // Inserts the chunks of one file in bulk, see gridfs.cpp.
+        class ChunkWriter;
 
-        // Insert a chunk into DB, this method is intended to be used by
-        // GridFileBuilder to incrementally insert chunks
-        void _insertChunk(const GridFSChunk& chunk);
+        // insert fileobject. All chunks must be in DB. If md5 is empty, it is computed by the
+        // server.
+        BSONObj insertFile(const std::string& name, const OID& id, gridfs_offset length, const std::string& contentType, const std::string& md5);
 
+        friend class ChunkWriter;
         friend class GridFile;
         friend class GridFileBuilder;
+        friend class GridFileReader;
     };
 
     /**
@@ -201,6 +232,16 @@ namespace mongo {
          */
         gridfs_offset write( const std::string& where ) const;
 
+        /**
+         * write the file to this filename, splitting its chunks into 'numStreams' contiguous
+         * ranges that are fetched concurrently, each over its own connection to 'host' taken
+         * from 'pool'
+         */
+        gridfs_offset writeParallel( const std::string& where,
+                                     DBClientConnectionPool& pool,
+                                     const HostAndPort& host,
+                                     int numStreams ) const;
+
     private:
         GridFile(const GridFS * grid , BSONObj obj );
 
@@ -210,6 +251,70 @@ namespace mongo {
         BSONObj        _obj;
 
         friend class GridFS;
+        friend class GridFileReader;
+    };
+
+    /**
+     * Reads the chunks of a GridFile in order over a single cursor, so that reading a file
+     * costs one round trip per batch of chunks rather than one per chunk.
+     */
+    class MONGO_CLIENT_API GridFileReader {
+        MONGO_DISALLOW_COPYING(GridFileReader);
+    public:
+        /**
+         * Reads every chunk of 'file' over the connection of the GridFS it came from.
+         */
+        explicit GridFileReader( const GridFile& file );
+
+        /**
+         * Reads chunks [beginChunk, endChunk) of 'file' over 'client', which must be
+         * connected to the same deployment as the GridFS the file came from.
+         */
+        GridFileReader( const GridFile& file , DBClientBase* client ,
+                        int beginChunk , int endChunk );
+
+        ~GridFileReader();
+
+        bool more();
+
+        /**
+         * @return the next chunk. Throws if the file is missing chunks.
+         * The chunk refers to the cursor's buffer, and becomes invalid once more() or next()
+         * is called again.
+         */
+        GridFSChunk next();
+
+    private:
+        void _init( const GridFile& file , DBClientBase* client );
+
+        const int _endChunk;
+        int _nextChunk;
+        std::auto_ptr<DBClientCursor> _cursor;
+    };
+
+    /**
+     * An istream over the contents of a GridFile, for serving large files without holding
+     * them in memory. Chunks are fetched as the stream is read.
+     */
+    class MONGO_CLIENT_API GridFileInputStream : public std::istream {
+        MONGO_DISALLOW_COPYING(GridFileInputStream);
+    public:
+        explicit GridFileInputStream( const GridFile& file );
+
+    private:
+        class StreamBuf : public std::streambuf {
+        public:
+            explicit StreamBuf( const GridFile& file );
+
+        protected:
+            virtual int_type underflow();
+
+        private:
+            GridFileReader _reader;
+            GridFSChunk _chunk;
+        };
+
+        StreamBuf _buf;
     };
     
     /**
@@ -221,6 +326,8 @@ namespace mongo {
          * @param grid - gridfs instance
          */
         GridFileBuilder( GridFS* const grid );
+
+        ~GridFileBuilder();
         
         /**
          * Appends a chunk of data. Data will be split as many times as
@@ -247,12 +354,11 @@ namespace mongo {
     private:
         GridFS* const _grid;
         const size_t _chunkSize; // taken from GridFS in the constructor
-        unsigned int _currentChunk;
         OID _fileId;
-        BSONObj _fileIdObj;
         boost::scoped_array<char> _pendingData; // pointer with _chunkSize space
         size_t _pendingDataSize;
         gridfs_offset _fileLength;
+        boost::scoped_ptr<GridFS::ChunkWriter> _chunkWriter;
 
         const char* _appendChunk( const char* data, size_t length,
                                   bool forcePendingInsert );
@@ -40,6 +40,10 @@ namespace client {
         // -1 = terminated
         AtomicWord<int> isInitialized;
 
+        // The appender attached to the global log domain, if it is asynchronous. Owned by the
+        // domain.
+        logger::AsyncAppender* asyncAppender = NULL;
+
         void callShutdownAtExit() {
             // We can't really do anything if this returns a non-OK status.
             mongo::client::shutdown();
@@ -54,7 +58,15 @@ namespace client {
                 logger::ComponentMessageLogDomain* globalLogDomain =
                     logger::globalLogManager()->getGlobalDomain();
 
-                globalLogDomain->attachAppender(appenderFactory());
+                Options::LogAppenderPtr appender = appenderFactory();
+                if (opts.logQueueSize() > 0) {
+                    asyncAppender = new logger::AsyncAppender(appender,
+                                                              opts.logQueueSize(),
+                                                              opts.logOverflowPolicy());
+                    appender.reset(asyncAppender);
+                }
+
+                globalLogDomain->attachAppender(appender);
                 globalLogDomain->setMinimumLoggedSeverity(opts.minLoggedSeverity());
             }
         }
@@ -116,6 +128,11 @@ namespace client {
 
         if (initStatus == 1) {
 
+            // Write out any queued log messages. Messages logged from now on, including those
+            // about shutting down, are written directly.
+            if (asyncAppender)
+                asyncAppender->stop();
+
             Status result = ReplicaSetMonitor::shutdown(Options::current().autoShutdownGracePeriodMillis());
             if (!result.isOK()) {
                 if (result == ErrorCodes::ExceededTimeLimit) {
@@ -126,6 +143,7 @@ namespace client {
                           << "ReplicaSetMonitor::shutdown() manually." << std::endl;
             }
             shutdownNetworking();
+
             return Status::OK();
         }
         else if (initStatus == 0) {
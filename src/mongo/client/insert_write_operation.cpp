@@ -26,11 +26,18 @@ namespace mongo {
     namespace {
         const char kCommandKey[] = "insert";
         const char kBatchName[] = "documents";
+
+        // The size of the _id element generated for a document which has none.
+        const int kIdElementSize = 1 + sizeof("_id") + OID::kOIDSize;
     } // namespace
 
     InsertWriteOperation::InsertWriteOperation(const BSONObj& doc)
-        : _doc(_ensureId(doc))
-    {}
+        : _doc(doc)
+        , _generateId(!doc.hasField("_id"))
+    {
+        if (_generateId)
+            _id = OID::gen();
+    }
 
     WriteOpType InsertWriteOperation::operationType() const {
         return dbWriteInsert;
@@ -41,7 +48,7 @@ namespace mongo {
     }
 
     int InsertWriteOperation::incrementalSize() const {
-        return _doc.objsize();
+        return _generateId ? _doc.objsize() + kIdElementSize : _doc.objsize();
     }
 
     void InsertWriteOperation::startRequest(const std::string& ns, bool ordered, BufBuilder* builder) const {
@@ -50,7 +57,11 @@ namespace mongo {
     }
 
     void InsertWriteOperation::appendSelfToRequest(BufBuilder* builder) const {
-        _doc.appendSelfToBufBuilder(*builder);
+        _appendDocument(builder);
+    }
+
+    const BSONObj* InsertWriteOperation::requestDocument() const {
+        return _generateId ? NULL : &_doc;
     }
 
     void InsertWriteOperation::startCommand(const std::string& ns, BSONObjBuilder* command) const {
@@ -58,21 +69,27 @@ namespace mongo {
     }
 
     void InsertWriteOperation::appendSelfToCommand(BSONArrayBuilder* batch) const {
-        batch->append(_doc);
+        _appendDocument(&batch->subobjStart());
     }
 
     void InsertWriteOperation::appendSelfToBSONObj(BSONObjBuilder* obj) const {
+        if (_generateId)
+            obj->append("_id", _id);
         obj->appendElements(_doc);
     }
 
-    BSONObj InsertWriteOperation::_ensureId(const BSONObj& doc) {
-        if (doc.hasField("_id"))
-            return doc;
-
-        BSONObjBuilder bob;
-        bob.append("_id", OID::gen());
-        bob.appendElements(doc);
-        return bob.obj();
+    void InsertWriteOperation::_appendDocument(BufBuilder* builder) const {
+        if (!_generateId) {
+            _doc.appendSelfToBufBuilder(*builder);
+            return;
+        }
+
+        // The _id element, then the elements and terminating EOO of the document as given.
+        builder->appendNum(_doc.objsize() + kIdElementSize);
+        builder->appendNum(static_cast<char>(jstOID));
+        builder->appendStr("_id");
+        builder->appendBuf(_id.view().view(), OID::kOIDSize);
+        builder->appendBuf(_doc.objdata() + sizeof(int), _doc.objsize() - sizeof(int));
     }
 
 } // namespace mongo
@@ -29,6 +29,7 @@ namespace mongo {
 
         virtual void startRequest(const std::string& ns, bool ordered, BufBuilder* builder) const;
         virtual void appendSelfToRequest(BufBuilder* builder) const;
+        virtual const BSONObj* requestDocument() const;
 
         virtual void startCommand(const std::string& ns, BSONObjBuilder* command) const;
         virtual void appendSelfToCommand(BSONArrayBuilder* batch) const;
@@ -36,9 +37,14 @@ namespace mongo {
         virtual void appendSelfToBSONObj(BSONObjBuilder* obj) const;
 
     private:
-        static BSONObj _ensureId(const BSONObj& doc);
+        // Appends the document, preceded by the generated _id if it has none of its own.
+        void _appendDocument(BufBuilder* builder) const;
 
+        // The document as given. An _id generated for it is only added as it is written out,
+        // so that the document is not copied to make room for it.
         const BSONObj _doc;
+        const bool _generateId;
+        OID _id;
     };
 
 } // namespace mongo
@@ -0,0 +1,94 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/client/insert_write_operation.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using namespace mongo;
+
+    BSONObj requestDocument(const InsertWriteOperation& op) {
+        BufBuilder builder;
+        op.appendSelfToRequest(&builder);
+        return BSONObj(builder.buf()).getOwned();
+    }
+
+    BSONObj commandDocument(const InsertWriteOperation& op) {
+        BSONArrayBuilder batch;
+        op.appendSelfToCommand(&batch);
+        return batch.arr().firstElement().Obj().getOwned();
+    }
+
+    BSONObj bsonObjDocument(const InsertWriteOperation& op) {
+        BSONObjBuilder builder;
+        op.appendSelfToBSONObj(&builder);
+        return builder.obj();
+    }
+
+    TEST(InsertWriteOperation, KeepsExistingId) {
+        const BSONObj doc = BSON("a" << 1 << "_id" << 2);
+        const InsertWriteOperation op(doc);
+
+        ASSERT_EQUALS(doc.objsize(), op.incrementalSize());
+        ASSERT_TRUE(op.requestDocument() != NULL);
+        ASSERT_EQUALS(doc.objdata(), op.requestDocument()->objdata());
+        ASSERT_EQUALS(doc, requestDocument(op));
+        ASSERT_EQUALS(doc, commandDocument(op));
+        ASSERT_EQUALS(doc, bsonObjDocument(op));
+    }
+
+    TEST(InsertWriteOperation, PrependsGeneratedId) {
+        const BSONObj doc = BSON("a" << 1 << "b" << BSON("c" << "d"));
+        const InsertWriteOperation op(doc);
+
+        // Nothing to send straight from the document's buffer: the _id must go first.
+        ASSERT_TRUE(op.requestDocument() == NULL);
+
+        const BSONObj request = requestDocument(op);
+        ASSERT_EQUALS(request.objsize(), op.incrementalSize());
+        ASSERT_EQUALS(std::string("_id"), request.firstElementFieldName());
+        ASSERT_EQUALS(jstOID, request.firstElement().type());
+
+        BSONObjBuilder expected;
+        expected.append(request.firstElement());
+        expected.appendElements(doc);
+        ASSERT_EQUALS(expected.obj(), request);
+
+        // Every encoding carries the same _id.
+        ASSERT_EQUALS(request, commandDocument(op));
+        ASSERT_EQUALS(request, bsonObjDocument(op));
+        ASSERT_TRUE(request.valid());
+    }
+
+    TEST(InsertWriteOperation, GeneratesDistinctIds) {
+        const BSONObj doc = BSON("a" << 1);
+        const InsertWriteOperation first(doc);
+        const InsertWriteOperation second(doc);
+        ASSERT_NOT_EQUALS(requestDocument(first)["_id"].OID(),
+                          requestDocument(second)["_id"].OID());
+    }
+
+    TEST(InsertWriteOperation, PrependsIdToEmptyDocument) {
+        const InsertWriteOperation op((BSONObj()));
+        const BSONObj request = requestDocument(op);
+        ASSERT_EQUALS(1, request.nFields());
+        ASSERT_EQUALS(jstOID, request["_id"].type());
+        ASSERT_TRUE(request.valid());
+    }
+
+} // namespace
@@ -0,0 +1,235 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/client/json_document_reader.h"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <cctype>
+#include <cstring>
+#include <istream>
+
+#include "mongo/client/bulk_operation_builder.h"
+#include "mongo/client/dbclientinterface.h"
+#include "mongo/db/json.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace {
+
+    const int kDefaultLinesPerChunk = 1024;
+
+    bool isBlank(const char* p, const char* end) {
+        for (; p != end; ++p) {
+            if (!isspace(static_cast<unsigned char>(*p)))
+                return false;
+        }
+        return true;
+    }
+
+    // Parses the document on 'line', or leaves 'doc' empty and sets 'error' if it does not
+    // parse. Runs on parser threads, so must not throw.
+    void parseLine(const std::string& line, BSONObj* doc, std::string* error) {
+        try {
+            int len = 0;
+            *doc = fromjson(line.c_str(), &len);
+            if (!isBlank(line.c_str() + len, line.c_str() + line.size())) {
+                *doc = BSONObj();
+                *error = str::stream() << "unexpected characters after the document at offset "
+                                       << len;
+            }
+        }
+        catch (const std::exception& e) {
+            *error = e.what();
+        }
+    }
+
+    void parseLines(const std::vector<std::string>* lines,
+                    size_t begin,
+                    size_t end,
+                    std::vector<BSONObj>* docs,
+                    std::vector<std::string>* errors) {
+        for (size_t i = begin; i != end; ++i)
+            parseLine((*lines)[i], &(*docs)[i], &(*errors)[i]);
+    }
+
+} // namespace
+
+    JsonDocumentReader::Options::Options()
+        : numParserThreads(0)
+        , linesPerChunk(kDefaultLinesPerChunk)
+    {}
+
+    JsonDocumentReader::JsonDocumentReader(std::istream& in, const Options& options)
+        : _options(options)
+        , _in(&in)
+        , _buffer(NULL)
+        , _bufferEnd(NULL)
+        , _numLines(0)
+        , _linesRead(0)
+        , _nextPending(0)
+        , _lineNumber(0)
+    {}
+
+    JsonDocumentReader::JsonDocumentReader(const StringData& buffer, const Options& options)
+        : _options(options)
+        , _in(NULL)
+        , _buffer(buffer.rawData())
+        , _bufferEnd(buffer.rawData() + buffer.size())
+        , _numLines(0)
+        , _linesRead(0)
+        , _nextPending(0)
+        , _lineNumber(0)
+    {}
+
+    bool JsonDocumentReader::next(BSONObj* doc) {
+        if (!_fill())
+            return false;
+        if (!_pendingErrors[_nextPending].empty())
+            _throwPendingError();
+
+        *doc = _pending[_nextPending];
+        _lineNumber = _pendingLineNumbers[_nextPending];
+        ++_nextPending;
+        return true;
+    }
+
+    bool JsonDocumentReader::nextBatch(std::vector<BSONObj>* batch,
+                                       size_t maxDocuments,
+                                       int maxBytes) {
+        batch->clear();
+        int batchBytes = 0;
+
+        while (batch->size() < maxDocuments && _fill()) {
+            // A line that does not parse ends the batch, and is reported by the next call.
+            if (!_pendingErrors[_nextPending].empty()) {
+                if (batch->empty())
+                    _throwPendingError();
+                break;
+            }
+
+            const BSONObj& doc = _pending[_nextPending];
+            if (!batch->empty() && batchBytes + doc.objsize() > maxBytes)
+                break;
+
+            batch->push_back(doc);
+            batchBytes += doc.objsize();
+            _lineNumber = _pendingLineNumbers[_nextPending];
+            ++_nextPending;
+        }
+
+        return !batch->empty();
+    }
+
+    bool JsonDocumentReader::nextBatch(DBClientBase* conn, std::vector<BSONObj>* batch) {
+        return nextBatch(batch, conn->getMaxWriteBatchSize(), conn->getMaxBsonObjectSize());
+    }
+
+    size_t JsonDocumentReader::insertInto(BulkOperationBuilder* bulk, size_t maxDocuments) {
+        size_t numQueued = 0;
+        BSONObj doc;
+        while (numQueued < maxDocuments && next(&doc)) {
+            bulk->insert(doc);
+            ++numQueued;
+        }
+        return numQueued;
+    }
+
+    bool JsonDocumentReader::_readLine(std::string* line) {
+        if (_in) {
+            if (!std::getline(*_in, *line))
+                return false;
+        }
+        else {
+            if (_buffer == _bufferEnd)
+                return false;
+
+            const char* end = static_cast<const char*>(
+                std::memchr(_buffer, '\n', _bufferEnd - _buffer));
+            if (!end)
+                end = _bufferEnd;
+
+            // Copied, since fromjson needs a null terminated string.
+            line->assign(_buffer, end);
+            _buffer = (end == _bufferEnd) ? end : end + 1;
+        }
+
+        ++_linesRead;
+        return true;
+    }
+
+    bool JsonDocumentReader::_fill() {
+        while (_nextPending == _pending.size()) {
+            // Read the next chunk of non-blank lines.
+            const size_t chunkSize = (_options.numParserThreads > 0) ?
+                std::max(_options.linesPerChunk, 1) : 1;
+            if (_lines.size() < chunkSize) {
+                _lines.resize(chunkSize);
+                _lineNumbers.resize(chunkSize);
+            }
+
+            _numLines = 0;
+            while (_numLines < chunkSize && _readLine(&_lines[_numLines])) {
+                const std::string& line = _lines[_numLines];
+                if (isBlank(line.data(), line.data() + line.size()))
+                    continue;
+                _lineNumbers[_numLines++] = _linesRead;
+            }
+
+            if (_numLines == 0)
+                return false;
+
+            _parseChunk();
+        }
+        return true;
+    }
+
+    void JsonDocumentReader::_parseChunk() {
+        _pending.assign(_numLines, BSONObj());
+        _pendingLineNumbers.assign(_lineNumbers.begin(), _lineNumbers.begin() + _numLines);
+        _pendingErrors.assign(_numLines, std::string());
+        _nextPending = 0;
+
+        // The calling thread takes the first share of the lines and the parser threads the
+        // rest, or all of them when there are no parser threads.
+        const size_t numShares = std::min(_numLines,
+                                          static_cast<size_t>(_options.numParserThreads) + 1);
+        const size_t linesPerShare = (_numLines + numShares - 1) / numShares;
+
+        boost::thread_group parsers;
+        for (size_t begin = linesPerShare; begin < _numLines; begin += linesPerShare) {
+            const size_t end = std::min(_numLines, begin + linesPerShare);
+            parsers.create_thread(boost::bind(&parseLines, &_lines, begin, end,
+                                              &_pending, &_pendingErrors));
+        }
+        parseLines(&_lines, 0, linesPerShare, &_pending, &_pendingErrors);
+        parsers.join_all();
+    }
+
+    void JsonDocumentReader::_throwPendingError() {
+        // Skip past the line, so that a caller who catches the error can carry on reading.
+        _lineNumber = _pendingLineNumbers[_nextPending];
+        const std::string error = _pendingErrors[_nextPending];
+        ++_nextPending;
+        uasserted(0, str::stream() << "failed to parse JSON document on line " << _lineNumber
+                                   << ": " << error);
+    }
+
+} // namespace mongo
@@ -0,0 +1,144 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/client/export_macros.h"
+
+namespace mongo {
+
+    class BulkOperationBuilder;
+    class DBClientBase;
+
+    /**
+     * Reads a stream of newline delimited JSON documents, as written by mongoexport, and
+     * yields them one at a time or in batches ready to be inserted:
+     *
+     *     std::ifstream in("dump.json");
+     *     JsonDocumentReader reader(in);
+     *     std::vector<BSONObj> batch;
+     *     while (reader.nextBatch(&conn, &batch))
+     *         conn.insert(ns, batch);
+     *
+     * Each non-blank line must hold exactly one document in any syntax fromjson accepts.
+     * Blank lines are skipped. Reaching a line that does not parse throws a DBException whose
+     * message gives the line number; reading can carry on after it from the following line.
+     *
+     * The input is read a line at a time into a reused buffer, so memory use does not grow
+     * with the size of the input. With Options::numParserThreads set, lines are read in
+     * chunks and each chunk is parsed on several threads at once; documents are still
+     * returned in input order.
+     *
+     * A reader is not thread safe.
+     */
+    class MONGO_CLIENT_API JsonDocumentReader {
+        MONGO_DISALLOW_COPYING(JsonDocumentReader);
+    public:
+        struct MONGO_CLIENT_API Options {
+            Options();
+
+            // Threads to parse on besides the calling thread. 0, the default, parses each
+            // line on the calling thread as it is read.
+            int numParserThreads;
+
+            // Lines to read before parsing them in parallel. Ignored with no parser threads.
+            int linesPerChunk;
+        };
+
+        /** Reads from 'in', which must outlive the reader. */
+        explicit JsonDocumentReader(std::istream& in, const Options& options = Options());
+
+        /**
+         * Reads from an in-memory buffer, such as a memory mapped file, which must outlive the
+         * reader. The buffer need not be null terminated.
+         */
+        explicit JsonDocumentReader(const StringData& buffer, const Options& options = Options());
+
+        /**
+         * Stores the next document in 'doc'.
+         *
+         * @return false, leaving 'doc' unchanged, if there are no more documents.
+         */
+        bool next(BSONObj* doc);
+
+        /**
+         * Replaces the contents of 'batch' with the next documents in the input, up to
+         * 'maxDocuments' of them and 'maxBytes' of BSON in total. A single document larger than
+         * 'maxBytes' makes a batch of its own.
+         *
+         * @return false, leaving 'batch' empty, if there are no more documents.
+         */
+        bool nextBatch(std::vector<BSONObj>* batch, size_t maxDocuments, int maxBytes);
+
+        /**
+         * Like nextBatch above, with batches sized to what 'conn' can accept in one insert:
+         * at most getMaxWriteBatchSize() documents and getMaxBsonObjectSize() bytes.
+         */
+        bool nextBatch(DBClientBase* conn, std::vector<BSONObj>* batch);
+
+        /**
+         * Queues the next 'maxDocuments' documents, or all of those remaining, as inserts on
+         * 'bulk'. The bulk operation splits them into batches the server accepts when it is
+         * executed.
+         *
+         * @return the number of documents queued, which is 0 at the end of the input.
+         */
+        size_t insertInto(BulkOperationBuilder* bulk, size_t maxDocuments = size_t(-1));
+
+        /** @return the line of the input the last document returned was read from. */
+        long long lineNumber() const { return _lineNumber; }
+
+    private:
+        // Reads the next line into 'line', and returns false at the end of the input.
+        bool _readLine(std::string* line);
+
+        // Makes sure _pending holds a document unless the input is exhausted.
+        bool _fill();
+        void _parseChunk();
+
+        // Throws the error for the next pending line, which did not parse, and skips it.
+        void _throwPendingError();
+
+        const Options _options;
+
+        std::istream* const _in;
+        const char* _buffer;
+        const char* const _bufferEnd;
+
+        // Lines read but not yet parsed, with their line numbers. The strings are reused.
+        std::vector<std::string> _lines;
+        std::vector<long long> _lineNumbers;
+        size_t _numLines;
+        long long _linesRead;
+
+        // Documents parsed but not yet returned, starting from _nextPending, with their line
+        // numbers and, for lines that did not parse, the error.
+        std::vector<BSONObj> _pending;
+        std::vector<long long> _pendingLineNumbers;
+        std::vector<std::string> _pendingErrors;
+        size_t _nextPending;
+
+        long long _lineNumber;
+    };
+
+} // namespace mongo
@@ -0,0 +1,168 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/client/json_document_reader.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/assert_util.h"
+
+namespace {
+
+    using mongo::BSONObj;
+    using mongo::JsonDocumentReader;
+    using mongo::StringData;
+
+    std::string numberedLines(int n) {
+        std::ostringstream lines;
+        for (int i = 0; i < n; ++i)
+            lines << "{ \"i\" : " << i << ", \"s\" : \"line " << i << "\" }\n";
+        return lines.str();
+    }
+
+    TEST(JsonDocumentReader, ReadsOneDocumentPerLine) {
+        std::istringstream in("{ a : 1 }\n{ \"b\" : \"two\" }\n{ c : { $numberLong : \"3\" } }");
+        JsonDocumentReader reader(in);
+
+        BSONObj doc;
+        ASSERT_TRUE(reader.next(&doc));
+        ASSERT_EQUALS(BSON("a" << 1), doc);
+        ASSERT_EQUALS(1, reader.lineNumber());
+        ASSERT_TRUE(reader.next(&doc));
+        ASSERT_EQUALS(BSON("b" << "two"), doc);
+        ASSERT_TRUE(reader.next(&doc));
+        ASSERT_EQUALS(BSON("c" << 3LL), doc);
+        ASSERT_EQUALS(3, reader.lineNumber());
+        ASSERT_FALSE(reader.next(&doc));
+        ASSERT_FALSE(reader.next(&doc));
+    }
+
+    TEST(JsonDocumentReader, SkipsBlankLinesAndCarriageReturns) {
+        const std::string input = "\r\n{ a : 1 }\r\n   \n\t\n{ a : 2 }  \r\n\n";
+        JsonDocumentReader reader(StringData(input.data(), input.size()));
+
+        BSONObj doc;
+        ASSERT_TRUE(reader.next(&doc));
+        ASSERT_EQUALS(BSON("a" << 1), doc);
+        ASSERT_EQUALS(2, reader.lineNumber());
+        ASSERT_TRUE(reader.next(&doc));
+        ASSERT_EQUALS(BSON("a" << 2), doc);
+        ASSERT_EQUALS(5, reader.lineNumber());
+        ASSERT_FALSE(reader.next(&doc));
+    }
+
+    TEST(JsonDocumentReader, BufferNeedNotBeNullTerminated) {
+        const std::string input = "{ a : 1 }\n{ a : 2 }XXXX";
+        JsonDocumentReader reader(StringData(input.data(), input.size() - 4));
+
+        BSONObj doc;
+        ASSERT_TRUE(reader.next(&doc));
+        ASSERT_TRUE(reader.next(&doc));
+        ASSERT_EQUALS(BSON("a" << 2), doc);
+        ASSERT_FALSE(reader.next(&doc));
+    }
+
+    TEST(JsonDocumentReader, BadLineThrowsAndReadingCarriesOn) {
+        std::istringstream in("{ a : 1 }\n{ a : \n{ a : 3 } junk\n{ a : 4 }\n");
+        JsonDocumentReader reader(in);
+
+        BSONObj doc;
+        ASSERT_TRUE(reader.next(&doc));
+        ASSERT_THROWS(reader.next(&doc), mongo::UserException);
+        ASSERT_EQUALS(2, reader.lineNumber());
+        ASSERT_THROWS(reader.next(&doc), mongo::UserException);
+        ASSERT_EQUALS(3, reader.lineNumber());
+        ASSERT_TRUE(reader.next(&doc));
+        ASSERT_EQUALS(BSON("a" << 4), doc);
+        ASSERT_FALSE(reader.next(&doc));
+    }
+
+    TEST(JsonDocumentReader, BatchesByDocumentCount) {
+        std::istringstream in(numberedLines(10));
+        JsonDocumentReader reader(in);
+
+        std::vector<BSONObj> batch;
+        ASSERT_TRUE(reader.nextBatch(&batch, 4, 16 * 1024 * 1024));
+        ASSERT_EQUALS(4U, batch.size());
+        ASSERT_EQUALS(0, batch[0]["i"].numberInt());
+        ASSERT_TRUE(reader.nextBatch(&batch, 4, 16 * 1024 * 1024));
+        ASSERT_EQUALS(4U, batch.size());
+        ASSERT_EQUALS(4, batch[0]["i"].numberInt());
+        ASSERT_TRUE(reader.nextBatch(&batch, 4, 16 * 1024 * 1024));
+        ASSERT_EQUALS(2U, batch.size());
+        ASSERT_EQUALS(10, reader.lineNumber());
+        ASSERT_FALSE(reader.nextBatch(&batch, 4, 16 * 1024 * 1024));
+        ASSERT_TRUE(batch.empty());
+    }
+
+    TEST(JsonDocumentReader, BatchesByBytes) {
+        std::istringstream in(numberedLines(5));
+        JsonDocumentReader reader(in);
+        const int docSize = BSON("i" << 0 << "s" << "line 0").objsize();
+
+        std::vector<BSONObj> batch;
+        ASSERT_TRUE(reader.nextBatch(&batch, 1000, 2 * docSize + 1));
+        ASSERT_EQUALS(2U, batch.size());
+
+        // A document bigger than the limit still makes a batch of its own.
+        ASSERT_TRUE(reader.nextBatch(&batch, 1000, 1));
+        ASSERT_EQUALS(1U, batch.size());
+        ASSERT_EQUALS(2, batch[0]["i"].numberInt());
+
+        ASSERT_TRUE(reader.nextBatch(&batch, 1000, 1000));
+        ASSERT_EQUALS(2U, batch.size());
+    }
+
+    TEST(JsonDocumentReader, BadLineEndsBatch) {
+        std::istringstream in("{ a : 1 }\n{ a : 2 }\nnot json\n{ a : 4 }\n");
+        JsonDocumentReader reader(in);
+
+        std::vector<BSONObj> batch;
+        ASSERT_TRUE(reader.nextBatch(&batch, 1000, 1000));
+        ASSERT_EQUALS(2U, batch.size());
+        ASSERT_THROWS(reader.nextBatch(&batch, 1000, 1000), mongo::UserException);
+        ASSERT_TRUE(reader.nextBatch(&batch, 1000, 1000));
+        ASSERT_EQUALS(1U, batch.size());
+        ASSERT_EQUALS(BSON("a" << 4), batch[0]);
+    }
+
+    TEST(JsonDocumentReader, ParallelParsingKeepsInputOrder) {
+        const int numDocs = 1000;
+        std::string input = numberedLines(numDocs);
+        input.insert(input.find("{ \"i\" : 500,"), "not json\n");
+
+        JsonDocumentReader::Options options;
+        options.numParserThreads = 3;
+        options.linesPerChunk = 37;
+        JsonDocumentReader reader(StringData(input.data(), input.size()), options);
+
+        BSONObj doc;
+        for (int i = 0; i < numDocs; ++i) {
+            if (i == 500) {
+                ASSERT_THROWS(reader.next(&doc), mongo::UserException);
+                ASSERT_EQUALS(501, reader.lineNumber());
+            }
+            ASSERT_TRUE(reader.next(&doc));
+            ASSERT_EQUALS(i, doc["i"].numberInt());
+            ASSERT_EQUALS(i < 500 ? i + 1 : i + 2, reader.lineNumber());
+        }
+        ASSERT_FALSE(reader.next(&doc));
+    }
+
+} // namespace
@@ -51,6 +51,8 @@ namespace client {
         , _sslAllowInvalidHostnames(false)
         , _defaultLocalThresholdMillis(kDefaultDefaultLocalThresholdMillis)
         , _minLoggedSeverity(logger::LogSeverity::Log())
+        , _logQueueSize(0)
+        , _logOverflowPolicy(logger::AsyncAppender::kBlock)
         , _validateObjects(false)
     {}
 
@@ -171,6 +173,24 @@ namespace client {
         return _minLoggedSeverity;
     }
 
+    Options& Options::setLogQueueSize(size_t size) {
+        _logQueueSize = size;
+        return *this;
+    }
+
+    size_t Options::logQueueSize() const {
+        return _logQueueSize;
+    }
+
+    Options& Options::setLogOverflowPolicy(logger::AsyncAppender::OverflowPolicy policy) {
+        _logOverflowPolicy = policy;
+        return *this;
+    }
+
+    logger::AsyncAppender::OverflowPolicy Options::logOverflowPolicy() const {
+        return _logOverflowPolicy;
+    }
+
     Options& Options::setValidateObjects(bool value) {
         _validateObjects = value;
         return *this;
@@ -18,6 +18,7 @@
 #include <string>
 
 #include "mongo/client/export_macros.h"
+#include "mongo/logger/async_appender.h"
 #include "mongo/logger/log_domain.h"
 #include "mongo/logger/message_log_domain.h"
 #include "mongo/stdx/functional.h"
@@ -208,6 +209,24 @@ namespace client {
         Options& setMinLoggedSeverity(logger::LogSeverity level);
         logger::LogSeverity minLoggedSeverity() const;
 
+        /** If non-zero, the log appender is called on a background thread, with up to this
+         *  many messages queued for it, so that threads logging do not wait for its I/O.
+         *  Queued messages are written by client::shutdown. Has no effect if logging is not
+         *  enabled.
+         *
+         *  Default: 0 (the log appender is called on the thread logging).
+         */
+        Options& setLogQueueSize(size_t size);
+        size_t logQueueSize() const;
+
+        /** Whether a thread logging waits for room when the log queue is full, or drops its
+         *  message. Has no effect if 'logQueueSize' is 0.
+         *
+         *  Default: logger::AsyncAppender::kBlock
+         */
+        Options& setLogOverflowPolicy(logger::AsyncAppender::OverflowPolicy policy);
+        logger::AsyncAppender::OverflowPolicy logOverflowPolicy() const;
+
         //
         // Misc
         //
@@ -233,6 +252,8 @@ namespace client {
         int _defaultLocalThresholdMillis;
         LogAppenderFactory _appenderFactory;
         logger::LogSeverity _minLoggedSeverity;
+        size_t _logQueueSize;
+        logger::AsyncAppender::OverflowPolicy _logOverflowPolicy;
         bool _validateObjects;
     };
 
@@ -20,6 +20,7 @@
 #include "mongo/client/replica_set_monitor.h"
 
 #include <algorithm>
+#include <deque>
 #include <limits>
 
 #include <boost/make_shared.hpp>
@@ -75,14 +76,19 @@ namespace {
      *          seedServers              -- list (map) of servers
      *          sets                     -- list (map) of ReplicaSetMonitors
      *
+     *          isMasterPool             -- threads calling isMaster for useParallelIsMaster
+     *
      *      Mutex locking order:
      *          watcherLock should be acquired first when acquiring it and any other lock.
      *          Don't lock setsLock while holding any SetState::mutex.
      *          It is however safe to grab a SetState::mutex without holding setsLock, but
      *          then you can't grab setsLock until you release the SetState::mutex.
+     *          isMasterPool's mutex may be taken while holding a SetState::mutex, and is
+     *          never held while taking any other lock.
      */
 
     class ReplicaSetMonitorWatcher;
+    class IsMasterPool;
 
     boost::mutex watcherLifetimeLock;
     boost::scoped_ptr<ReplicaSetMonitorWatcher> replicaSetMonitorWatcher;
@@ -195,6 +201,127 @@ namespace {
         bool _stopRequested;
     };
 
+    // Threads which call isMaster for refreshes when ReplicaSetMonitor::useParallelIsMaster is
+    // set. They are shared by every set so that a burst of refreshes cannot start an unbounded
+    // number of threads, and are started on first use.
+    class IsMasterPool {
+        MONGO_DISALLOW_COPYING(IsMasterPool);
+    public:
+        typedef stdx::function<void ()> Task;
+
+        IsMasterPool()
+            : _stopRequested(false)
+            , _numThreads(0)
+            , _numIdle(0)
+            , _threads(new boost::thread_group()) {
+        }
+
+        /**
+         * Queues 'contact' to run on a pool thread. If the pool is stopped before it runs,
+         * 'abandon' runs instead, on the stopping thread. Returns false, running neither, if
+         * the pool is stopping or has no thread to run 'contact' on.
+         */
+        bool schedule(const Task& contact, const Task& abandon) {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            if (_stopRequested)
+                return false;
+
+            // Idle threads woken for calls already queued have yet to take them, so only
+            // more queued calls than idle threads leave this one without a thread.
+            if (_queue.size() >= static_cast<size_t>(_numIdle) &&
+                _numThreads < std::max(1, ReplicaSetMonitor::maxParallelIsMasterThreads)) {
+                try {
+                    _threads->create_thread(stdx::bind(&IsMasterPool::_run, this));
+                    ++_numThreads;
+                }
+                catch (const boost::thread_resource_error&) {
+                    if (_numThreads == 0)
+                        return false;
+                }
+            }
+
+            _queue.push_back(std::make_pair(contact, abandon));
+            _workAvailable.notify_one();
+            return true;
+        }
+
+        /**
+         * Abandons the queued calls and waits for the threads to finish the calls in progress
+         * and exit, for at most 'gracePeriodMillis' if it is not 0. Returns false if they did
+         * not exit in time. Once stopped, the pool can be used again.
+         */
+        bool stop(int gracePeriodMillis) {
+            Queue abandoned;
+            {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                _stopRequested = true;
+                _workAvailable.notify_all();
+                abandoned.swap(_queue);
+            }
+
+            for (Queue::const_iterator it = abandoned.begin(); it != abandoned.end(); ++it)
+                it->second();
+
+            const boost::system_time deadline = boost::get_system_time() +
+                boost::posix_time::milliseconds(gracePeriodMillis);
+
+            boost::unique_lock<boost::mutex> lk(_mutex);
+            while (_numThreads > 0) {
+                if (gracePeriodMillis == 0)
+                    _threadExited.wait(lk);
+                else if (!_threadExited.timed_wait(lk, deadline))
+                    return false;
+            }
+
+            // Every thread has returned from _run, so joining them does not block.
+            _threads->join_all();
+            _threads.reset(new boost::thread_group());
+            _stopRequested = false;
+            return true;
+        }
+
+    private:
+        typedef std::deque<std::pair<Task, Task> > Queue;
+
+        void _run() {
+            boost::unique_lock<boost::mutex> lk(_mutex);
+            while (true) {
+                while (_queue.empty() && !_stopRequested) {
+                    ++_numIdle;
+                    _workAvailable.wait(lk);
+                    --_numIdle;
+                }
+                if (_stopRequested)
+                    break;
+
+                const Task contact = _queue.front().first;
+                _queue.pop_front();
+
+                lk.unlock();
+                contact();
+                lk.lock();
+            }
+
+            --_numThreads;
+            _threadExited.notify_all();
+        }
+
+        // protects all members
+        boost::mutex _mutex;
+        boost::condition_variable _workAvailable;
+        boost::condition_variable _threadExited;
+
+        Queue _queue;
+        bool _stopRequested;
+        int _numThreads;
+        int _numIdle;
+        boost::scoped_ptr<boost::thread_group> _threads;
+    };
+
+    // Never destroyed, so that nothing waits for its threads during static destruction.
+    // ReplicaSetMonitor::shutdown stops them.
+    IsMasterPool& isMasterPool = *new IsMasterPool();
+
     //
     // Helpers for stl algorithms
     //
@@ -243,6 +370,10 @@ namespace {
     // Defaults to random selection as required by the spec
     bool ReplicaSetMonitor::useDeterministicHostSelection = false;
 
+    bool ReplicaSetMonitor::useParallelIsMaster = false;
+
+    int ReplicaSetMonitor::maxParallelIsMasterThreads = 8;
+
     ReplicaSetMonitor::ReplicaSetMonitor(StringData name, const std::set<HostAndPort>& seeds)
             : _state(boost::make_shared<SetState>(name, seeds)) {
         LogstreamBuilder lsb = log();
@@ -472,6 +603,13 @@ namespace {
                           "Timed out waiting for ReplicaSetMonitorWatcher to shutdown");
         }
         replicaSetMonitorWatcher.reset();
+
+        // Leave no thread contacting hosts once we return.
+        if (!isMasterPool.stop(gracePeriodMillis)) {
+            return Status(ErrorCodes::ExceededTimeLimit,
+                          "Timed out waiting for isMaster calls to finish");
+        }
+
         boost::lock_guard<boost::mutex> lockSets(setsLock);
         sets = StringMap<ReplicaSetMonitorPtr>();
         seedServers = StringMap<set<HostAndPort> >();
@@ -767,10 +905,24 @@ namespace {
                 continue;
 
             case NextStep::CONTACT_HOST: {
+                DEV _set->checkInvariants();
+
+                if (ReplicaSetMonitor::useParallelIsMaster) {
+                    // Dispatch and go straight on to the next host. Once every host is in
+                    // flight getNextStep says WAIT, and each reply wakes us as it lands. A
+                    // host whose call is abandoned at shutdown is treated as unreachable.
+                    if (isMasterPool.schedule(
+                            stdx::bind(&Refresher::_contactHost, *this, ns.host),
+                            stdx::bind(&Refresher::_applyReply, *this, ns.host, 0, BSONObj()))) {
+                        continue;
+                    }
+                    LOG(1) << "unable to queue isMaster for " << ns.host
+                           << ", contacting it inline";
+                }
+
                 BSONObj reply; // empty on error
                 int64_t pingMicros = 0;
 
-                DEV _set->checkInvariants();
                 lk.unlock(); // relocked after attempting to call isMaster
 
                 try {
@@ -782,20 +934,60 @@ namespace {
 
                 lk.lock();
 
-                // Ignore the reply and return if we are no longer the current scan. This might
-                // happen if it was decided that the host we were contacting isn't part of the set.
-                if (_scan != _set->currentScan)
+                // Return if we are no longer the current scan. This might happen if it was
+                // decided that the host we were contacting isn't part of the set.
+                if (!_receivedReply(ns.host, pingMicros, reply))
                     return criteria ? _set->getMatchingHost(*criteria) : HostAndPort();
-
-                if (reply.isEmpty())
-                    failedHost(ns.host);
-                else
-                    receivedIsMaster(ns.host, pingMicros, reply);
             }
             }
         }
     }
 
+    void Refresher::_contactHost(Refresher refresher, const HostAndPort& host) {
+        BSONObj reply; // empty on error
+        int64_t pingMicros = 0;
+
+        try {
+            pingMicros = refresher._set->connectionCache.timedIsMaster(host, &reply);
+        } catch (...) {
+            LOG(2) << "failed to execute isMaster on host: " << host;
+            reply = BSONObj();
+        }
+
+        _applyReply(refresher, host, pingMicros, reply);
+    }
+
+    void Refresher::_applyReply(Refresher refresher,
+                                const HostAndPort& host,
+                                int64_t pingMicros,
+                                const BSONObj& reply) {
+        boost::lock_guard<boost::mutex> lk(refresher._set->mutex);
+        try {
+            if (!refresher._receivedReply(host, pingMicros, reply)) {
+                // Anyone still waiting on the old scan needs to notice it is over.
+                refresher._set->cv.notify_all();
+            }
+        }
+        catch (const std::exception& e) {
+            warning() << "failed to process isMaster reply from " << host << ": " << e.what();
+            refresher._set->cv.notify_all();
+        }
+    }
+
+    bool Refresher::_receivedReply(const HostAndPort& host,
+                                   int64_t pingMicros,
+                                   const BSONObj& reply) {
+        // Ignore the reply if we are no longer the current scan.
+        if (_scan != _set->currentScan)
+            return false;
+
+        if (reply.isEmpty())
+            failedHost(host);
+        else
+            receivedIsMaster(host, pingMicros, reply);
+        return true;
+    }
+
     void IsMasterReply::parse(const BSONObj& obj) {
         try {
             raw = obj.getOwned(); // don't use obj again after this line
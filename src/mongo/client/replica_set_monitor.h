@@ -185,6 +185,21 @@ namespace mongo {
          */
         static int maxConsecutiveFailedChecks;
 
+        /**
+         * Defaults to false, meaning that a refresh contacts the hosts it needs one at a time.
+         * When true, isMaster is sent to every host a refresh can contact at once, on a shared
+         * pool of threads, and replies are applied as they arrive. A refresh looking for a
+         * matching host then waits for the first suitable reply rather than for every
+         * unreachable member ahead of it to time out.
+         */
+        static bool useParallelIsMaster;
+
+        /**
+         * The most threads calling isMaster for useParallelIsMaster at once, across all sets.
+         * Further hosts wait for a thread to be free. The threads are stopped by shutdown().
+         */
+        static int maxParallelIsMasterThreads;
+
         //
         // internal types (defined in replica_set_monitor_internal.h)
         //
@@ -327,6 +342,28 @@ namespace mongo {
          */
         HostAndPort _refreshUntilMatches(const ReadPreferenceSetting* criteria);
 
+        /**
+         * Calls isMaster on a host returned from getNextStep and applies the outcome to the
+         * set, unless the scan has been superseded by then. Runs on the isMaster pool when
+         * useParallelIsMaster is set, with its own copy of the Refresher. Handles own locking.
+         */
+        static void _contactHost(Refresher refresher, const HostAndPort& host);
+
+        /**
+         * Applies the outcome of an isMaster call made by _contactHost, waking any thread
+         * waiting on the scan. An empty reply means the call failed. Handles own locking.
+         */
+        static void _applyReply(Refresher refresher,
+                                const HostAndPort& host,
+                                int64_t pingMicros,
+                                const BSONObj& reply);
+
+        /**
+         * Applies the outcome of an isMaster call made without the lock. Returns false if the
+         * scan has been superseded, in which case the outcome is ignored.
+         */
+        bool _receivedReply(const HostAndPort& host, int64_t pingMicros, const BSONObj& reply);
+
         // Both pointers are never NULL
         SetStatePtr _set;
         ScanStatePtr _scan; // May differ from _set->currentScan if a new scan has started.
@@ -35,12 +35,14 @@ namespace mongo {
         SaslClientConversation(saslClientSession),
         _step(0),
         _authMessage(""),
+        _iterationCount(0),
+        _clientKeysCached(false),
         _clientNonce("") {
     }
 
     SaslSCRAMSHA1ClientConversation::~SaslSCRAMSHA1ClientConversation(){
-        // clear the _saltedPassword memory
-        memset(_saltedPassword, 0, scram::hashSize);
+        // clear the _clientKeys memory
+        memset(&_clientKeys, 0, sizeof(_clientKeys));
     }
 
     StatusWith<bool> SaslSCRAMSHA1ClientConversation::step(const StringData& inputData,
@@ -153,22 +155,35 @@ namespace mongo {
         // Append client-final-message-without-proof to _authMessage
         _authMessage += "c=biws,r=" + nonce;
 
-        std::string decodedSalt;
         try {
-            decodedSalt = base64::decode(salt);
+            _salt = base64::decode(salt);
         }
         catch (const DBException& ex) {
             return StatusWith<bool>(ex.toStatus());
         }
+        _iterationCount = iterationCount;
+
+        // Deriving the keys takes iterationCount rounds of HMAC, so reauthenticating as the
+        // same user with the same password reuses the keys from last time.
+        const StringData user =
+            _saslClientSession->getParameter(SaslClientSession::parameterUser);
+        const StringData password =
+            _saslClientSession->getParameter(SaslClientSession::parameterPassword);
+        _clientKeysCached = scram::findCachedClientKeys(user, password, _salt, _iterationCount,
+                                                        &_clientKeys);
+        if (!_clientKeysCached) {
+            unsigned char saltedPassword[scram::hashSize];
+            scram::generateSaltedPassword(
+                                password,
+                                reinterpret_cast<const unsigned char*>(_salt.c_str()),
+                                _salt.size(),
+                                _iterationCount,
+                                saltedPassword);
+            scram::generateClientKeys(saltedPassword, &_clientKeys);
+            memset(saltedPassword, 0, scram::hashSize);
+        }
 
-        scram::generateSaltedPassword(
-                            _saslClientSession->getParameter(SaslClientSession::parameterPassword),
-                            reinterpret_cast<const unsigned char*>(decodedSalt.c_str()),
-                            decodedSalt.size(),
-                            iterationCount,
-                            _saltedPassword);
-
-        std::string clientProof = scram::generateClientProof(_saltedPassword, _authMessage);
+        std::string clientProof = scram::generateClientProof(_clientKeys, _authMessage);
 
         StringBuilder sb;
         sb << "c=biws,r=" << nonce << ",p=" << clientProof;
@@ -206,7 +221,7 @@ namespace mongo {
         }
 
         bool validServerSignature =
-            scram::verifyServerSignature(_saltedPassword, _authMessage, input[0].substr(2));
+            scram::verifyServerSignature(_clientKeys, _authMessage, input[0].substr(2));
 
         if (!validServerSignature) {
             *outputData = "e=Invalid server signature";
@@ -215,6 +230,16 @@ namespace mongo {
                     input[0].substr(2));
         }
 
+        // Only keys the server has proven it also holds are worth keeping.
+        if (!_clientKeysCached) {
+            scram::cacheClientKeys(
+                _saslClientSession->getParameter(SaslClientSession::parameterUser),
+                _saslClientSession->getParameter(SaslClientSession::parameterPassword),
+                _salt,
+                _iterationCount,
+                _clientKeys);
+        }
+
         *outputData = "";
 
         return StatusWith<bool>(true);
@@ -66,7 +66,13 @@ namespace mongo {
 
         int _step;
         std::string _authMessage;
-        unsigned char _saltedPassword[scram::hashSize];
+        scram::ClientKeys _clientKeys;
+
+        // The decoded salt and iteration count the server sent, and whether the keys they
+        // were derived with came from the cache or still need adding to it.
+        std::string _salt;
+        int _iterationCount;
+        bool _clientKeysCached;
 
         // client and server nonce concatenated
         std::string _clientNonce;
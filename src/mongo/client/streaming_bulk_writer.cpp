@@ -0,0 +1,172 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/client/streaming_bulk_writer.h"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <memory>
+
+#include "mongo/client/dbclient_writer.h"
+#include "mongo/client/dbclientinterface.h"
+#include "mongo/client/delete_write_operation.h"
+#include "mongo/client/exceptions.h"
+#include "mongo/client/insert_write_operation.h"
+#include "mongo/client/update_write_operation.h"
+#include "mongo/client/write_options.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+
+    inline bool compare(WriteOperation* const lhs, WriteOperation* const rhs) {
+        return lhs->operationType() > rhs->operationType();
+    }
+
+    void deleteOperations(std::vector<WriteOperation*>* operations) {
+        std::vector<WriteOperation*>::iterator it;
+        for (it = operations->begin(); it != operations->end(); ++it)
+            delete *it;
+        operations->clear();
+    }
+
+} // namespace
+
+    StreamingBulkWriter::StreamingBulkWriter(DBClientBase* const client,
+                                             const std::string& ns,
+                                             bool ordered,
+                                             const WriteConcern* writeConcern)
+        : _client(client)
+        , _ns(ns)
+        , _ordered(ordered)
+        , _writeConcern(writeConcern)
+        , _numEnqueued(0)
+        , _finished(false)
+        , _pendingBytes(0)
+        , _failed(false)
+    {
+        _result._requiresDetailedInsertResults = true;
+    }
+
+    StreamingBulkWriter::~StreamingBulkWriter() {
+        _waitForFlush();
+        deleteOperations(&_pending);
+    }
+
+    void StreamingBulkWriter::insert(const BSONObj& doc) {
+        _enqueue(new InsertWriteOperation(doc.getOwned()));
+    }
+
+    void StreamingBulkWriter::update(const BSONObj& selector,
+                                     const BSONObj& update,
+                                     bool upsert,
+                                     bool multi) {
+        int flags = 0;
+        if (upsert)
+            flags |= UpdateOption_Upsert;
+        if (multi)
+            flags |= UpdateOption_Multi;
+        _enqueue(new UpdateWriteOperation(selector.getOwned(), update.getOwned(), flags));
+    }
+
+    void StreamingBulkWriter::remove(const BSONObj& selector, bool justOne) {
+        _enqueue(new DeleteWriteOperation(selector.getOwned(),
+                                          justOne ? RemoveOption_JustOne : 0));
+    }
+
+    void StreamingBulkWriter::finish(WriteResult* writeResult) {
+        uassert(0, "Streaming bulk writes cannot be finished twice", !_finished);
+        _finished = true;
+
+        _waitForFlush();
+        if (!_failed && !_pending.empty())
+            _startFlush();
+        _waitForFlush();
+        deleteOperations(&_pending);
+
+        writeResult->_mergeWriteResult(_result);
+        if (_failed)
+            throw OperationException(_error);
+        writeResult->_check(true);
+    }
+
+    void StreamingBulkWriter::_enqueue(WriteOperation* operation) {
+        std::auto_ptr<WriteOperation> owned(operation);
+        uassert(0, "Streaming bulk writes cannot be enqueued after finish()", !_finished);
+
+        // Send what is pending first if this operation would take it over the limit.
+        const int size = operation->incrementalSize() + kWriteBatchOperationOverhead;
+        if (!_pending.empty() &&
+            _pendingBytes + size > _client->getMaxBsonObjectSize() - kWriteBatchOverhead)
+            _startFlush();
+
+        operation->setBulkIndex(_numEnqueued);
+        _pending.push_back(owned.release());
+        _pendingBytes += size;
+        ++_numEnqueued;
+
+        if (_pending.size() >= static_cast<size_t>(_client->getMaxWriteBatchSize()))
+            _startFlush();
+    }
+
+    void StreamingBulkWriter::_startFlush() {
+        _waitForFlush();
+        if (_failed)
+            throw OperationException(_error);
+
+        _flushing.swap(_pending);
+        _pendingBytes = 0;
+        _flusher.reset(new boost::thread(boost::bind(&StreamingBulkWriter::_flush, this)));
+    }
+
+    void StreamingBulkWriter::_waitForFlush() {
+        if (!_flusher)
+            return;
+        _flusher->join();
+        _flusher.reset();
+    }
+
+    void StreamingBulkWriter::_flush() {
+        if (!_ordered)
+            std::stable_sort(_flushing.begin(), _flushing.end(), compare);
+
+        WriteResult batchResult;
+        batchResult._requiresDetailedInsertResults = true;
+
+        try {
+            _client->_write(_ns, _flushing, _ordered, _writeConcern, &batchResult);
+        }
+        catch (const OperationException& ex) {
+            // Write concern errors, and write errors when unordered, do not stop the writes.
+            if (!batchResult._isOwnWriteConcernError(ex.obj()) &&
+                (_ordered || !batchResult._isOwnWriteError(ex.obj()))) {
+                _failed = true;
+                _error = ex.obj().getOwned();
+            }
+        }
+        catch (const std::exception& ex) {
+            _failed = true;
+            _error = WriteResult::_errorFromException(ex);
+        }
+
+        _result._mergeWriteResult(batchResult);
+        deleteOperations(&_flushing);
+    }
+
+} // namespace mongo
@@ -0,0 +1,135 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <boost/scoped_ptr.hpp>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/client/export_macros.h"
+#include "mongo/client/write_result.h"
+
+namespace boost {
+    class thread;
+} // namespace boost
+
+namespace mongo {
+
+    class DBClientBase;
+    class WriteConcern;
+    class WriteOperation;
+
+    /**
+     * Writes a stream of operations too large to hold in memory at once, such as a bulk
+     * load, sending them as they are enqueued instead of all at the end:
+     *
+     *     StreamingBulkWriter writer(&conn, "test.foo", false);
+     *     while (...)
+     *         writer.insert(nextDocument());
+     *     WriteResult result;
+     *     writer.finish(&result);
+     *
+     * Once enough operations are enqueued to fill a batch, bounded by the server's
+     * maxWriteBatchSize and maxBsonObjectSize, they are written on a background thread while
+     * the caller carries on enqueuing. At most one batch is being written and one filled at a
+     * time, so memory use does not grow with the number of operations, and time spent on the
+     * network overlaps time spent producing operations.
+     *
+     * The operations make up a single bulk write. finish() reports the result for all of
+     * them, with write errors and upserts indexed by the order the operations were enqueued
+     * in, and throws as BulkOperationBuilder::execute does. An unordered writer carries on past
+     * write errors. An ordered writer sends nothing more after one; the error is thrown from
+     * the call that would have sent the next batch, and from finish(). Errors other than write
+     * errors, such as a lost connection, stop either kind of writer and are thrown as an
+     * OperationException in the same way.
+     *
+     * Since operations are written some time after they are enqueued, the writer keeps its
+     * own copy of any document that does not own its buffer, such as one read from a cursor.
+     *
+     * The connection must not be used for anything else until finish() returns. A writer is
+     * not thread safe.
+     */
+    class MONGO_CLIENT_API StreamingBulkWriter {
+        MONGO_DISALLOW_COPYING(StreamingBulkWriter);
+    public:
+        /**
+         * @param client The connection to write on.
+         * @param ns The namespace to apply the operations to.
+         * @param ordered Whether the operations must be applied in the order enqueued.
+         * @param writeConcern The write concern for every batch, which must outlive the writer.
+         *     NULL uses the connection's write concern.
+         */
+        StreamingBulkWriter(DBClientBase* client,
+                            const std::string& ns,
+                            bool ordered,
+                            const WriteConcern* writeConcern = NULL);
+
+        /** Waits for the batch being written, if any. Operations not yet sent are dropped. */
+        ~StreamingBulkWriter();
+
+        void insert(const BSONObj& doc);
+
+        void update(const BSONObj& selector,
+                    const BSONObj& update,
+                    bool upsert = false,
+                    bool multi = false);
+
+        void remove(const BSONObj& selector, bool justOne = false);
+
+        /**
+         * Sends the operations not yet sent, waits for every batch to be written, and merges
+         * the result for all of the operations into 'writeResult'.
+         */
+        void finish(WriteResult* writeResult);
+
+        /** @return the number of operations enqueued so far. */
+        size_t numEnqueued() const { return _numEnqueued; }
+
+    private:
+        void _enqueue(WriteOperation* operation);
+
+        // Waits for the batch being written, then starts writing the pending operations.
+        void _startFlush();
+        void _waitForFlush();
+
+        // Runs on the background thread.
+        void _flush();
+
+        DBClientBase* const _client;
+        const std::string _ns;
+        const bool _ordered;
+        const WriteConcern* const _writeConcern;
+
+        size_t _numEnqueued;
+        bool _finished;
+
+        // Operations enqueued but not yet sent, and their total size.
+        std::vector<WriteOperation*> _pending;
+        int _pendingBytes;
+
+        // Operations being written by _flusher. The fields below are only read by the caller's
+        // thread once _flusher has been joined.
+        std::vector<WriteOperation*> _flushing;
+        boost::scoped_ptr<boost::thread> _flusher;
+
+        WriteResult _result;
+        bool _failed;
+        BSONObj _error;
+    };
+
+} // namespace mongo
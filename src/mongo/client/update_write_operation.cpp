@@ -61,14 +61,18 @@ namespace mongo {
         _update.appendSelfToBufBuilder(*builder);
     }
 
+    const BSONObj* UpdateWriteOperation::requestDocument() const {
+        return NULL;
+    }
+
     void UpdateWriteOperation::startCommand(const std::string& ns, BSONObjBuilder* command) const {
         command->append(kCommandKey, nsToCollectionSubstring(ns));
     }
 
     void UpdateWriteOperation::appendSelfToCommand(BSONArrayBuilder* batch) const {
-        BSONObjBuilder updateBuilder;
+        BSONObjBuilder updateBuilder(batch->subobjStart());
         appendSelfToBSONObj(&updateBuilder);
-        batch->append(updateBuilder.obj());
+        updateBuilder.doneFast();
     }
 
     void UpdateWriteOperation::appendSelfToBSONObj(BSONObjBuilder* obj) const {
@@ -20,11 +20,23 @@
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/client/write_result.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/util/net/message.h"
 
 namespace mongo {
 
-    WireProtocolWriter::WireProtocolWriter(DBClientBase* client) : _client(client) {
-    }
+    namespace {
+        // Documents at least this large are sent from the caller's buffer as their own iovec.
+        // Smaller ones are cheaper to copy than to give a segment of their own.
+        const int kMinBorrowedDocumentSize = 1024;
+
+        // writeOne() keeps a buffer up to this size between calls and frees a larger one.
+        const int kMaxRetainedBufferSize = 64 * 1024;
+    } // namespace
+
+    WireProtocolWriter::WireProtocolWriter(DBClientBase* client)
+        : _client(client)
+        , _singleOp(1)
+    {}
 
     void WireProtocolWriter::write(
         const StringData& ns,
@@ -36,8 +48,6 @@ namespace mongo {
         // Effectively a map of batch relative indexes to WriteOperations
         std::vector<WriteOperation*> batchOps;
 
-        BufBuilder builder;
-
         std::vector<WriteOperation*>::const_iterator batch_begin = write_operations.begin();
         const std::vector<WriteOperation*>::const_iterator end = write_operations.end();
 
@@ -47,19 +57,26 @@ namespace mongo {
 
             // We must be able to fit the first item of the batch. Otherwise, the calling code
             // passed an over size write operation in violation of our contract.
-            invariant(_fits(&builder, *batch_iter));
+            invariant(_fits(0, *batch_iter));
 
             // Set the current operation type for this batch
             const WriteOpType batchOpType = (*batch_iter)->operationType();
 
-            // Begin the command for this batch.
-            (*batch_iter)->startRequest(ns.toString(), ordered, &builder);
+            // The request goes out as a list of buffers: the header and preamble first, then
+            // the documents, either copied into owned buffers or referenced where they are.
+            Message request;
+            boost::scoped_ptr<BufBuilder> builder(new BufBuilder());
+            builder->skip(MsgData::MsgDataHeaderSize);
+
+            // Begin the request for this batch.
+            (*batch_iter)->startRequest(ns.toString(), ordered, builder.get());
+            int requestSize = builder->len() - MsgData::MsgDataHeaderSize;
 
             while (true) {
 
                 // Always safe to append here: either we just entered the loop, or all the
                 // below checks passed.
-                (*batch_iter)->appendSelfToRequest(&builder);
+                requestSize += _appendToRequest(*batch_iter, &request, &builder);
 
                 // Associate batch index with WriteOperation
                 batchOps.push_back(*batch_iter);
@@ -85,15 +102,16 @@ namespace mongo {
                     break;
 
                 // If we can't put the next item into the current batch, issue what we have.
-                if (!_fits(&builder, *next))
+                if (!_fits(requestSize, *next))
                     break;
 
                 // OK to proceed to next op
                 batch_iter = next;
             }
 
-            // Issue the complete command.
-            BSONObj batchResult = _send(batchOpType, builder, writeConcern, ns);
+            // Issue the complete request.
+            _flushBuffer(&request, &builder);
+            BSONObj batchResult = _send(batchOpType, request, writeConcern, ns);
 
             // Merge this batch's result into the result for all batches written.
             writeResult->_mergeGleResult(batchOps, batchResult);
@@ -104,27 +122,77 @@ namespace mongo {
             if (ordered || lastOp)
                 writeResult->_check(lastOp);
 
-            // Reset the builder so we can build the next request.
-            builder.reset();
-
             // The next batch begins with the op after the last one in the just issued batch.
             batch_begin = ++batch_iter;
         }
 
     }
 
-    bool WireProtocolWriter::_fits(BufBuilder* builder, WriteOperation* op) {
-        return (builder->len() + op->incrementalSize()) <= _client->getMaxMessageSizeBytes();
+    void WireProtocolWriter::writeOne(
+        const std::string& ns,
+        WriteOperation* op,
+        const WriteConcern* writeConcern,
+        WriteResult* writeResult
+    ) {
+        invariant(_fits(0, op));
+
+        _buffer.reset(kMaxRetainedBufferSize);
+        _buffer.skip(MsgData::MsgDataHeaderSize);
+        op->startRequest(ns, true, &_buffer);
+        op->appendSelfToRequest(&_buffer);
+
+        // The message is sent from the buffer, which it does not take ownership of.
+        MsgData::View header = _buffer.buf();
+        header.setLen(_buffer.len());
+        Message request(_buffer.buf(), false);
+        BSONObj result = _send(op->operationType(), request, writeConcern, ns);
+
+        _singleOp[0] = op;
+        writeResult->_mergeGleResult(_singleOp, result);
+        writeResult->_check(true);
+    }
+
+    bool WireProtocolWriter::_fits(int requestSize, WriteOperation* op) {
+        return (requestSize + op->incrementalSize()) <= _client->getMaxMessageSizeBytes();
+    }
+
+    int WireProtocolWriter::_appendToRequest(
+        WriteOperation* op,
+        Message* request,
+        boost::scoped_ptr<BufBuilder>* builder
+    ) {
+        const BSONObj* doc = op->requestDocument();
+
+        if (!doc || doc->objsize() < kMinBorrowedDocumentSize) {
+            const int before = (*builder)->len();
+            op->appendSelfToRequest(builder->get());
+            return (*builder)->len() - before;
+        }
+
+        // Whatever was copied so far must precede the borrowed document on the wire.
+        _flushBuffer(request, builder);
+        request->appendBorrowedData(doc->objdata(), doc->objsize());
+        return doc->objsize();
+    }
+
+    void WireProtocolWriter::_flushBuffer(Message* request, boost::scoped_ptr<BufBuilder>* builder) {
+        if ((*builder)->len() == 0)
+            return;
+
+        request->appendData((*builder)->buf(), (*builder)->len());
+        (*builder)->decouple();
+
+        // A decoupled BufBuilder cannot be written to again.
+        builder->reset(new BufBuilder());
     }
 
     BSONObj WireProtocolWriter::_send(
         WriteOpType opCode,
-        const BufBuilder& builder,
+        Message& request,
         const WriteConcern* writeConcern,
         const StringData& ns
     ) {
-        Message request;
-        request.setData(opCode, builder.buf(), builder.len());
+        request.header().setOperation(opCode);
         _client->say(request);
 
         BSONObj result;
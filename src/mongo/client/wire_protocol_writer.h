@@ -15,11 +15,14 @@
 
 #pragma once
 
+#include <boost/scoped_ptr.hpp>
+
 #include "mongo/client/dbclient_writer.h"
 
 namespace mongo {
 
     class DBClientBase;
+    class Message;
 
     class WireProtocolWriter : public DBClientWriter {
     public:
@@ -33,18 +36,40 @@ namespace mongo {
             WriteResult* writeResult
         );
 
+        virtual void writeOne(
+            const std::string& ns,
+            WriteOperation* op,
+            const WriteConcern* writeConcern,
+            WriteResult* writeResult
+        );
+
     private:
         BSONObj _send(
             WriteOpType opCode,
-            const BufBuilder& builder,
+            Message& request,
             const WriteConcern* wc,
             const StringData& ns
         );
 
+        // Appends 'op' to the request, copying it into 'builder' or referencing its document
+        // in place. Returns the number of bytes it adds to the request.
+        int _appendToRequest(
+            WriteOperation* op,
+            Message* request,
+            boost::scoped_ptr<BufBuilder>* builder
+        );
+
+        // Moves the contents of 'builder' into the request as a buffer of its own.
+        void _flushBuffer(Message* request, boost::scoped_ptr<BufBuilder>* builder);
+
         bool _batchableRequest(WriteOpType opCode, const WriteResult* const writeResult);
-        bool _fits(BufBuilder* builder, WriteOperation* operation);
+        bool _fits(int requestSize, WriteOperation* operation);
 
         DBClientBase* const _client;
+
+        // The buffer writeOne() builds its requests in, and the operation it is writing.
+        BufBuilder _buffer;
+        std::vector<WriteOperation*> _singleOp;
     };
 
 } // namespace mongo
@@ -127,19 +127,21 @@ namespace mongo {
      */
     BSONObj WriteConcern::obj() const {
         BSONObjBuilder write_concern;
+        appendSelfToBSONObj(&write_concern);
+        return write_concern.obj();
+    }
 
+    void WriteConcern::appendSelfToBSONObj(BSONObjBuilder* builder) const {
         if (_enabled.test(kW))
-            write_concern.append("w", _w);
+            builder->append("w", _w);
         if (_enabled.test(kWStr))
-            write_concern.append("w", _w_str);
+            builder->append("w", _w_str);
         if (_enabled.test(kJ))
-            write_concern.append("j", _j);
+            builder->append("j", _j);
         if (_enabled.test(kFsync))
-            write_concern.append("fsync", _fsync);
+            builder->append("fsync", _fsync);
         if (_enabled.test(kTimeout))
-            write_concern.append("wtimeout", _timeout);
-
-        return write_concern.obj();
+            builder->append("wtimeout", _timeout);
     }
 
 } // namespace mongo
@@ -128,6 +128,9 @@ namespace mongo {
         /** Turn write concern into an object for inclusion in GetLastError or write command */
         BSONObj obj() const;
 
+        /** Append the fields of obj() to 'builder', without building a separate object */
+        void appendSelfToBSONObj(BSONObjBuilder* builder) const;
+
     private:
         // Enabled option book keeping
         static const size_t kNumOptions = 5;
@@ -74,6 +74,15 @@ namespace mongo {
          */
         virtual void appendSelfToRequest(BufBuilder* builder) const = 0;
 
+        /**
+         * Returns the document that appendSelfToRequest would copy into the request, if that
+         * is all it appends, or NULL otherwise.
+         *
+         * A WireProtocolWriter may send such a document straight from its own buffer instead
+         * of copying it, so the document must stay valid until the request has been sent.
+         */
+        virtual const BSONObj* requestDocument() const = 0;
+
         /**
          * Appends the preamble for a write command into the supplied BSONObjBuilder.
          *
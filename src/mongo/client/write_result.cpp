@@ -206,6 +206,23 @@ namespace mongo {
         }
     }
 
+    void WriteResult::_mergeWriteResult(const WriteResult& other) {
+        _nInserted += other._nInserted;
+        _nUpserted += other._nUpserted;
+        _nMatched += other._nMatched;
+        _nModified += other._nModified;
+        _nRemoved += other._nRemoved;
+
+        _upserted.insert(_upserted.end(), other._upserted.begin(), other._upserted.end());
+        _writeErrors.insert(_writeErrors.end(),
+                            other._writeErrors.begin(), other._writeErrors.end());
+        _writeConcernErrors.insert(_writeConcernErrors.end(),
+                                   other._writeConcernErrors.begin(),
+                                   other._writeConcernErrors.end());
+
+        _hasModifiedCount = _hasModifiedCount && other._hasModifiedCount;
+    }
+
     void WriteResult::_check(bool throwSoftErrors) {
         if (hasWriteErrors())
             throw OperationException(writeErrors().back());
@@ -214,6 +231,21 @@ namespace mongo {
         }
     }
 
+    bool WriteResult::_isOwnWriteError(const BSONObj& error) const {
+        return hasWriteErrors() && writeErrors().back().objdata() == error.objdata();
+    }
+
+    bool WriteResult::_isOwnWriteConcernError(const BSONObj& error) const {
+        return hasWriteConcernErrors() &&
+            writeConcernErrors().front().objdata() == error.objdata();
+    }
+
+    BSONObj WriteResult::_errorFromException(const std::exception& ex) {
+        if (const DBException* dbex = dynamic_cast<const DBException*>(&ex))
+            return BSON("ok" << 0 << "code" << dbex->getCode() << "errmsg" << dbex->what());
+        return BSON("ok" << 0 << "errmsg" << ex.what());
+    }
+
     /**
      * SERVER-13001 - mixed sharded cluster could return nModified
      * (servers >= 2.6) or not (servers <= 2.4). If any call does
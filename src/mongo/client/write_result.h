@@ -15,6 +15,7 @@
 
 #pragma once
 
+#include <exception>
 #include <vector>
 
 #include "mongo/client/export_macros.h"
@@ -35,6 +36,7 @@ namespace mongo {
         friend class WireProtocolWriter;
         friend class CommandWriter;
         friend class BulkOperationBuilder;
+        friend class StreamingBulkWriter;
 
     public:
 
@@ -144,8 +146,18 @@ namespace mongo {
     private:
         void _mergeCommandResult(const std::vector<WriteOperation*>& ops, const BSONObj& result);
         void _mergeGleResult(const std::vector<WriteOperation*>& ops, const BSONObj& result);
+        void _mergeWriteResult(const WriteResult& other);
 
         void _check(bool throwSoftErrors);
+
+        // Whether 'error', the document of an OperationException thrown by _check, is the
+        // write error or the write concern error this result holds, rather than a failure
+        // to write at all. The exception shares the result's document, so its identity tells.
+        bool _isOwnWriteError(const BSONObj& error) const;
+        bool _isOwnWriteConcernError(const BSONObj& error) const;
+
+        // Describes 'ex', thrown while writing, as a command reply would describe a failure.
+        static BSONObj _errorFromException(const std::exception& ex);
         void _setModified(const BSONObj& result);
         int _getIntOrDefault(const BSONObj& obj, const StringData& field, const int defaultValue = 0);
 
@@ -18,6 +18,9 @@
 
 #include "mongo/crypto/mechanism_scram.h"
 
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
 #include <vector>
 
 #include "mongo/crypto/crypto.h"
@@ -27,6 +30,42 @@
 namespace mongo {
 namespace scram {
 
+namespace {
+
+    struct ClientKeyCacheKey {
+        ClientKeyCacheKey(const StringData& user,
+                          const StringData& hashedPassword,
+                          const StringData& salt,
+                          int iterationCount)
+            : user(user.toString())
+            , hashedPassword(hashedPassword.toString())
+            , salt(salt.toString())
+            , iterationCount(iterationCount)
+        {}
+
+        bool operator<(const ClientKeyCacheKey& other) const {
+            if (iterationCount != other.iterationCount)
+                return iterationCount < other.iterationCount;
+            if (salt != other.salt)
+                return salt < other.salt;
+            if (user != other.user)
+                return user < other.user;
+            return hashedPassword < other.hashedPassword;
+        }
+
+        std::string user;
+        std::string hashedPassword;
+        std::string salt;
+        int iterationCount;
+    };
+
+    typedef std::map<ClientKeyCacheKey, ClientKeys> ClientKeyCache;
+
+    boost::mutex clientKeyCacheMutex;
+    ClientKeyCache clientKeyCache;
+
+} // namespace
+
     // Compute the SCRAM step Hi() as defined in RFC5802
     static void HMACIteration(const unsigned char input[],
                               size_t inputLen,
@@ -164,17 +203,36 @@ namespace scram {
 
     std::string generateClientProof(const unsigned char saltedPassword[hashSize],
                                     const std::string& authMessage) {
+        ClientKeys keys;
+        generateClientKeys(saltedPassword, &keys);
+        return generateClientProof(keys, authMessage);
+    }
 
-        // ClientKey := HMAC(saltedPassword, "Client Key")
-        unsigned char clientKey[hashSize];
+    void generateClientKeys(const unsigned char saltedPassword[hashSize], ClientKeys* keys) {
         unsigned int hashLen = 0;
+
+        // ClientKey := HMAC(saltedPassword, "Client Key")
         fassert(18689,
                 crypto::hmacSha1(saltedPassword,
                                  hashSize,
                                  reinterpret_cast<const unsigned char*>(clientKeyConst.data()),
                                  clientKeyConst.size(),
-                                 clientKey,
+                                 keys->clientKey,
+                                 &hashLen));
+
+        // ServerKey := HMAC(SaltedPassword, "Server Key")
+        fassert(18703,
+                crypto::hmacSha1(saltedPassword,
+                                 hashSize,
+                                 reinterpret_cast<const unsigned char*>(serverKeyConst.data()),
+                                 serverKeyConst.size(),
+                                 keys->serverKey,
                                  &hashLen));
+    }
+
+    std::string generateClientProof(const ClientKeys& keys, const std::string& authMessage) {
+        const unsigned char* const clientKey = keys.clientKey;
+        unsigned int hashLen = 0;
 
         // StoredKey := H(clientKey)
         unsigned char storedKey[hashSize];
@@ -203,22 +261,20 @@ namespace scram {
     bool verifyServerSignature(const unsigned char saltedPassword[hashSize],
                                const std::string& authMessage,
                                const std::string& receivedServerSignature) {
+        ClientKeys keys;
+        generateClientKeys(saltedPassword, &keys);
+        return verifyServerSignature(keys, authMessage, receivedServerSignature);
+    }
 
-        // ServerKey       := HMAC(SaltedPassword, "Server Key")
+    bool verifyServerSignature(const ClientKeys& keys,
+                               const std::string& authMessage,
+                               const std::string& receivedServerSignature) {
         unsigned int hashLen;
-        unsigned char serverKey[hashSize];
-        fassert(18703,
-                crypto::hmacSha1(saltedPassword,
-                                 hashSize,
-                                 reinterpret_cast<const unsigned char*>(serverKeyConst.data()),
-                                 serverKeyConst.size(),
-                                 serverKey,
-                                 &hashLen));
 
         // ServerSignature := HMAC(ServerKey, AuthMessage)
         unsigned char serverSignature[hashSize];
         fassert(18704,
-                crypto::hmacSha1(serverKey,
+                crypto::hmacSha1(keys.serverKey,
                                  hashSize,
                                  reinterpret_cast<const unsigned char*>(authMessage.c_str()),
                                  authMessage.size(),
@@ -230,5 +286,38 @@ namespace scram {
         return (receivedServerSignature == encodedServerSignature);
     }
 
+    bool findCachedClientKeys(const StringData& user,
+                              const StringData& hashedPassword,
+                              const StringData& salt,
+                              int iterationCount,
+                              ClientKeys* keys) {
+        const ClientKeyCacheKey key(user, hashedPassword, salt, iterationCount);
+
+        boost::lock_guard<boost::mutex> lk(clientKeyCacheMutex);
+        const ClientKeyCache::const_iterator it = clientKeyCache.find(key);
+        if (it == clientKeyCache.end())
+            return false;
+        *keys = it->second;
+        return true;
+    }
+
+    void cacheClientKeys(const StringData& user,
+                         const StringData& hashedPassword,
+                         const StringData& salt,
+                         int iterationCount,
+                         const ClientKeys& keys) {
+        const ClientKeyCacheKey key(user, hashedPassword, salt, iterationCount);
+
+        boost::lock_guard<boost::mutex> lk(clientKeyCacheMutex);
+        if (clientKeyCache.size() >= maxCachedClientKeys && !clientKeyCache.count(key))
+            clientKeyCache.erase(clientKeyCache.begin());
+        clientKeyCache[key] = keys;
+    }
+
+    void clearClientKeyCache() {
+        boost::lock_guard<boost::mutex> lk(clientKeyCacheMutex);
+        clientKeyCache.clear();
+    }
+
 } // namespace scram
 } // namespace mongo
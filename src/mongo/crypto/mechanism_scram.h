@@ -64,6 +64,25 @@ namespace scram {
     std::string generateClientProof(const unsigned char saltedPassword[hashSize],
                                     const std::string& authMessage);
 
+    /*
+     * The ClientKey and ServerKey derived from SaltedPassword, which are all the client side
+     * needs to prove itself and to verify the server.
+     */
+    struct ClientKeys {
+        unsigned char clientKey[hashSize];
+        unsigned char serverKey[hashSize];
+    };
+
+    /*
+     * Computes ClientKey and ServerKey from SaltedPassword (client side).
+     */
+    void generateClientKeys(const unsigned char saltedPassword[hashSize], ClientKeys* keys);
+
+    /*
+     * Computes the ClientProof from ClientKey and authMessage (client side).
+     */
+    std::string generateClientProof(const ClientKeys& keys, const std::string& authMessage);
+
     /*
      * Validates that the provided password 'hashedPassword' generates the serverKey
      * 'serverKey' given iteration count 'iterationCount' and salt 'salt'.
@@ -79,5 +98,44 @@ namespace scram {
     bool verifyServerSignature(const unsigned char saltedPassword[hashSize],
                                const std::string& authMessage,
                                const std::string& serverSignature);
+
+    /*
+     * Verifies ServerSignature using ServerKey (client side).
+     */
+    bool verifyServerSignature(const ClientKeys& keys,
+                               const std::string& authMessage,
+                               const std::string& serverSignature);
+
+    /*
+     * The most ClientKeys the process-wide cache holds. Once full, an arbitrary entry is
+     * dropped to make room for each new one.
+     */
+    const size_t maxCachedClientKeys = 1024;
+
+    /*
+     * Looks up the ClientKeys last cached for 'user' with 'hashedPassword', 'salt' and
+     * 'iterationCount' (client side), so that reauthenticating need not iterate the hash
+     * function again. Returns false if there are none. Thread safe.
+     */
+    bool findCachedClientKeys(const StringData& user,
+                              const StringData& hashedPassword,
+                              const StringData& salt,
+                              int iterationCount,
+                              ClientKeys* keys);
+
+    /*
+     * Caches 'keys' as derived for 'user' from 'hashedPassword', 'salt' and 'iterationCount'
+     * (client side). Only keys the server has been verified with should be cached. Thread safe.
+     */
+    void cacheClientKeys(const StringData& user,
+                         const StringData& hashedPassword,
+                         const StringData& salt,
+                         int iterationCount,
+                         const ClientKeys& keys);
+
+    /*
+     * Empties the ClientKeys cache.
+     */
+    void clearClientKeyCache();
 } // namespace scram
 } // namespace mongo
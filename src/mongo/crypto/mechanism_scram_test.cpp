@@ -0,0 +1,144 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/crypto/mechanism_scram.h"
+
+#include <cstring>
+#include <string>
+
+#include "mongo/crypto/crypto.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/base64.h"
+
+namespace mongo {
+namespace {
+
+    const std::string password = "6f1f2ba8c8ad1a4b7f2db8e0ea0a1eea";
+    const unsigned char salt[] = { 0x5d, 0x1e, 0x4a, 0x90, 0x0c, 0x2b, 0x7f, 0x33,
+                                   0xa1, 0x46, 0xd2, 0x88, 0x17, 0xe9, 0x6c, 0x05 };
+    const int iterationCount = 100;
+    const std::string authMessage = "n=user,r=clientnonce,r=clientnonceservernonce,"
+                                    "s=XR5KkAwrfzOhRtKIF+lsBQ==,i=100,c=biws,"
+                                    "r=clientnonceservernonce";
+
+    void deriveKeys(scram::ClientKeys* keys) {
+        unsigned char saltedPassword[scram::hashSize];
+        scram::generateSaltedPassword(password, salt, sizeof(salt), iterationCount,
+                                      saltedPassword);
+        scram::generateClientKeys(saltedPassword, keys);
+    }
+
+    std::string serverSignature(const scram::ClientKeys& keys) {
+        unsigned char signature[scram::hashSize];
+        unsigned int signatureLen = 0;
+        crypto::hmacSha1(keys.serverKey, scram::hashSize,
+                         reinterpret_cast<const unsigned char*>(authMessage.data()),
+                         authMessage.size(), signature, &signatureLen);
+        return base64::encode(reinterpret_cast<const char*>(signature), signatureLen);
+    }
+
+    bool keysEqual(const scram::ClientKeys& lhs, const scram::ClientKeys& rhs) {
+        return std::memcmp(lhs.clientKey, rhs.clientKey, scram::hashSize) == 0 &&
+               std::memcmp(lhs.serverKey, rhs.serverKey, scram::hashSize) == 0;
+    }
+
+    TEST(MechanismScram, ClientKeysMatchServerSecrets) {
+        scram::ClientKeys keys;
+        deriveKeys(&keys);
+
+        unsigned char storedKey[scram::hashSize];
+        unsigned char serverKey[scram::hashSize];
+        scram::generateSecrets(password, salt, sizeof(salt), iterationCount,
+                               storedKey, serverKey);
+
+        unsigned char hashedClientKey[scram::hashSize];
+        crypto::sha1(keys.clientKey, scram::hashSize, hashedClientKey);
+        ASSERT_EQUALS(0, std::memcmp(storedKey, hashedClientKey, scram::hashSize));
+        ASSERT_EQUALS(0, std::memcmp(serverKey, keys.serverKey, scram::hashSize));
+    }
+
+    TEST(MechanismScram, ClientKeysAgreeWithSaltedPassword) {
+        unsigned char saltedPassword[scram::hashSize];
+        scram::generateSaltedPassword(password, salt, sizeof(salt), iterationCount,
+                                      saltedPassword);
+        scram::ClientKeys keys;
+        scram::generateClientKeys(saltedPassword, &keys);
+
+        ASSERT_EQUALS(scram::generateClientProof(saltedPassword, authMessage),
+                      scram::generateClientProof(keys, authMessage));
+
+        const std::string signature = serverSignature(keys);
+        ASSERT_TRUE(scram::verifyServerSignature(saltedPassword, authMessage, signature));
+        ASSERT_TRUE(scram::verifyServerSignature(keys, authMessage, signature));
+        ASSERT_FALSE(scram::verifyServerSignature(keys, authMessage + "x", signature));
+    }
+
+    TEST(MechanismScram, CacheMatchesOnlyTheSameCredentials) {
+        scram::clearClientKeyCache();
+        scram::ClientKeys keys;
+        deriveKeys(&keys);
+        const std::string encodedSalt = base64::encode(reinterpret_cast<const char*>(salt),
+                                                       sizeof(salt));
+
+        scram::ClientKeys found;
+        ASSERT_FALSE(scram::findCachedClientKeys("user", password, encodedSalt,
+                                                 iterationCount, &found));
+
+        scram::cacheClientKeys("user", password, encodedSalt, iterationCount, keys);
+        ASSERT_TRUE(scram::findCachedClientKeys("user", password, encodedSalt,
+                                                iterationCount, &found));
+        ASSERT_TRUE(keysEqual(keys, found));
+
+        ASSERT_FALSE(scram::findCachedClientKeys("other", password, encodedSalt,
+                                                 iterationCount, &found));
+        ASSERT_FALSE(scram::findCachedClientKeys("user", password + "x", encodedSalt,
+                                                 iterationCount, &found));
+        ASSERT_FALSE(scram::findCachedClientKeys("user", password, "c2FsdA==",
+                                                 iterationCount, &found));
+        ASSERT_FALSE(scram::findCachedClientKeys("user", password, encodedSalt,
+                                                 iterationCount + 1, &found));
+
+        scram::clearClientKeyCache();
+        ASSERT_FALSE(scram::findCachedClientKeys("user", password, encodedSalt,
+                                                 iterationCount, &found));
+    }
+
+    TEST(MechanismScram, CacheIsBounded) {
+        scram::clearClientKeyCache();
+        scram::ClientKeys keys;
+        std::memset(&keys, 0, sizeof(keys));
+
+        const int numCached = static_cast<int>(scram::maxCachedClientKeys) + 10;
+        for (int i = 0; i < numCached; ++i)
+            scram::cacheClientKeys("user", password, "salt", i, keys);
+
+        size_t numFound = 0;
+        scram::ClientKeys found;
+        for (int i = 0; i < numCached; ++i) {
+            if (scram::findCachedClientKeys("user", password, "salt", i, &found))
+                ++numFound;
+        }
+        ASSERT_EQUALS(scram::maxCachedClientKeys, numFound);
+
+        // The entry just cached is always kept.
+        ASSERT_TRUE(scram::findCachedClientKeys("user", password, "salt", numCached - 1,
+                                                &found));
+        scram::clearClientKeyCache();
+    }
+
+} // namespace
+} // namespace mongo
@@ -51,19 +51,40 @@ namespace mongo {
 
     // Size hints given to char vectors
     enum {
-        ID_RESERVE_SIZE = 64,
         PAT_RESERVE_SIZE = 4096,
         OPT_RESERVE_SIZE = 64,
-        FIELD_RESERVE_SIZE = 4096,
-        STRINGVAL_RESERVE_SIZE = 4096,
         BINDATA_RESERVE_SIZE = 4096,
         BINDATATYPE_RESERVE_SIZE = 4096,
         NS_RESERVE_SIZE = 64,
-        DB_RESERVE_SIZE = 64,
-        NUMBERLONG_RESERVE_SIZE = 64,
-        DATE_RESERVE_SIZE = 64
+        DB_RESERVE_SIZE = 64
     };
 
+    namespace {
+        // May appear unescaped in a quoted string: anything but '\\' and CONTROLCHAR.
+        inline bool isPlainStringChar(char c) {
+            return static_cast<unsigned char>(c) > 0x1F && c != '\\';
+        }
+
+        // May appear in an unquoted field name: [a-zA-Z0-9$_].
+        inline bool isFieldChar(char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                   c == '_' || c == '$';
+        }
+
+        inline bool isDecimalDigit(char c) {
+            return c >= '0' && c <= '9';
+        }
+
+        // 'hex' must be 24 hex digits.
+        OID oidFromHex(const StringData& hex) {
+            unsigned char bytes[OID::kOIDSize];
+            for (std::size_t i = 0; i < OID::kOIDSize; i++) {
+                bytes[i] = fromHex(hex.rawData() + 2 * i);
+            }
+            return OID(bytes);
+        }
+    } // namespace
+
     static const char* LBRACE = "{",
                  *RBRACE = "}",
                  *LBRACKET = "[",
@@ -94,6 +115,27 @@ namespace mongo {
 
     Status JParse::value(const StringData& fieldName, BSONObjBuilder& builder) {
         MONGO_JSON_DEBUG("fieldName: " << fieldName);
+
+        // Strings and plain numbers make up most values and cannot be mistaken for any of the
+        // tokens tried below, so look for them first.
+        const char* next = _input;
+        while (next < _input_end && isspace(*reinterpret_cast<const unsigned char*>(next))) {
+            ++next;
+        }
+        if (next < _input_end && (*next == '"' || *next == '\'')) {
+            std::string scratch;
+            StringData valueString;
+            Status ret = quotedStringView(&valueString, &scratch);
+            if (ret != Status::OK()) {
+                return ret;
+            }
+            builder.append(fieldName, valueString);
+            return Status::OK();
+        }
+        if (next < _input_end && isDecimalDigit(*next)) {
+            return number(fieldName, builder);
+        }
+
         if (peekToken(LBRACE)) {
             Status ret = object(fieldName, builder);
             if (ret != Status::OK()) {
@@ -154,15 +196,6 @@ namespace mongo {
                 return ret;
             }
         }
-        else if (peekToken(DOUBLEQUOTE) || peekToken(SINGLEQUOTE)) {
-            std::string valueString;
-            valueString.reserve(STRINGVAL_RESERVE_SIZE);
-            Status ret = quotedString(&valueString);
-            if (ret != Status::OK()) {
-                return ret;
-            }
-            builder.append(fieldName, valueString);
-        }
         else if (readToken("true")) {
             builder.append(fieldName, true);
         }
@@ -213,9 +246,9 @@ namespace mongo {
         }
 
         // Special object
-        std::string firstField;
-        firstField.reserve(FIELD_RESERVE_SIZE);
-        Status ret = field(&firstField);
+        std::string scratch;
+        StringData firstField;
+        Status ret = fieldView(&firstField, &scratch);
         if (ret != Status::OK()) {
             return ret;
         }
@@ -329,9 +362,8 @@ namespace mongo {
                 return valueRet;
             }
             while (readToken(COMMA)) {
-                std::string fieldName;
-                fieldName.reserve(FIELD_RESERVE_SIZE);
-                Status fieldRet = field(&fieldName);
+                StringData fieldName;
+                Status fieldRet = fieldView(&fieldName, &scratch);
                 if (fieldRet != Status::OK()) {
                     return fieldRet;
                 }
@@ -354,19 +386,19 @@ namespace mongo {
         if (!readToken(COLON)) {
             return parseError("Expected ':'");
         }
-        std::string id;
-        id.reserve(ID_RESERVE_SIZE);
-        Status ret = quotedString(&id);
+        std::string scratch;
+        StringData id;
+        Status ret = quotedStringView(&id, &scratch);
         if (ret != Status::OK()) {
             return ret;
         }
         if (id.size() != 24) {
-            return parseError("Expecting 24 hex digits: " + id);
+            return parseError("Expecting 24 hex digits: " + id.toString());
         }
         if (!isHexString(id)) {
-            return parseError("Expecting hex digits: " + id);
+            return parseError("Expecting hex digits: " + id.toString());
         }
-        builder.append(fieldName, OID(id));
+        builder.append(fieldName, oidFromHex(id));
         return Status::OK();
     }
 
@@ -421,9 +453,9 @@ namespace mongo {
         Date_t date;
 
         if (peekToken(DOUBLEQUOTE)) {
-            std::string dateString;
-            dateString.reserve(DATE_RESERVE_SIZE);
-            Status ret = quotedString(&dateString);
+            std::string scratch;
+            StringData dateString;
+            Status ret = quotedStringView(&dateString, &scratch);
             if (!ret.isOK()) {
                 return ret;
             }
@@ -434,9 +466,9 @@ namespace mongo {
             date = dateRet.getValue();
         }
         else if (readToken(LBRACE)) {
-            std::string fieldName;
-            fieldName.reserve(FIELD_RESERVE_SIZE);
-            Status ret = field(&fieldName);
+            std::string scratch;
+            StringData fieldName;
+            Status ret = fieldView(&fieldName, &scratch);
             if (ret != Status::OK()) {
                 return ret;
             }
@@ -449,9 +481,8 @@ namespace mongo {
 
             // The number must be a quoted string, since large long numbers could overflow a double
             // and thus may not be valid JSON
-            std::string numberLongString;
-            numberLongString.reserve(NUMBERLONG_RESERVE_SIZE);
-            ret = quotedString(&numberLongString);
+            StringData numberLongString;
+            ret = quotedStringView(&numberLongString, &scratch);
             if (!ret.isOK()) {
                 return ret;
             }
@@ -652,9 +683,9 @@ namespace mongo {
 
         // The number must be a quoted string, since large long numbers could overflow a double and
         // thus may not be valid JSON
-        std::string numberLongString;
-        numberLongString.reserve(NUMBERLONG_RESERVE_SIZE);
-        Status ret = quotedString(&numberLongString);
+        std::string scratch;
+        StringData numberLongString;
+        Status ret = quotedStringView(&numberLongString, &scratch);
         if (!ret.isOK()) {
             return ret;
         }
@@ -813,9 +844,9 @@ namespace mongo {
         if (!readToken(LPAREN)) {
             return parseError("Expecting '('");
         }
-        std::string id;
-        id.reserve(ID_RESERVE_SIZE);
-        Status ret = quotedString(&id);
+        std::string scratch;
+        StringData id;
+        Status ret = quotedStringView(&id, &scratch);
         if (ret != Status::OK()) {
             return ret;
         }
@@ -823,12 +854,12 @@ namespace mongo {
             return parseError("Expecting ')'");
         }
         if (id.size() != 24) {
-            return parseError("Expecting 24 hex digits: " + id);
+            return parseError("Expecting 24 hex digits: " + id.toString());
         }
         if (!isHexString(id)) {
-            return parseError("Expecting hex digits: " + id);
+            return parseError("Expecting hex digits: " + id.toString());
         }
-        builder.append(fieldName, OID(id));
+        builder.append(fieldName, oidFromHex(id));
         return Status::OK();
     }
 
@@ -969,6 +1000,35 @@ namespace mongo {
     }
 
     Status JParse::number(const StringData& fieldName, BSONObjBuilder& builder) {
+        // Plain decimal integers too short to overflow are parsed here rather than with both
+        // strtod and strtoll. Anything strtod would read further than strtoll (a fraction, an
+        // exponent or hex) takes the general path below.
+        const char* p = _input;
+        while (p < _input_end && isspace(*reinterpret_cast<const unsigned char*>(p))) {
+            ++p;
+        }
+        const bool negative = (p < _input_end && *p == '-');
+        if (negative) {
+            ++p;
+        }
+        const char* const digits = p;
+        long long digitsValue = 0;
+        while (p < _input_end && p - digits < 18 && isDecimalDigit(*p)) {
+            digitsValue = digitsValue * 10 + (*p - '0');
+            ++p;
+        }
+        if (p > digits && p < _input_end && !isDecimalDigit(*p) && !match(*p, ".eExX")) {
+            const long long retll = negative ? -digitsValue : digitsValue;
+            if (retll == static_cast<int>(retll)) {
+                builder.append(fieldName, static_cast<int>(retll));
+            }
+            else {
+                builder.append(fieldName, retll);
+            }
+            _input = p;
+            return Status::OK();
+        }
+
         char* endptrll;
         char* endptrd;
         long long retll;
@@ -1015,11 +1075,20 @@ namespace mongo {
     }
 
     Status JParse::field(std::string* result) {
+        StringData view;
+        Status ret = fieldView(&view, result);
+        if (ret == Status::OK() && view.rawData() != result->data()) {
+            result->assign(view.rawData(), view.size());
+        }
+        return ret;
+    }
+
+    Status JParse::fieldView(StringData* result, std::string* scratch) {
         MONGO_JSON_DEBUG("");
         if (peekToken(DOUBLEQUOTE) || peekToken(SINGLEQUOTE)) {
             // Quoted key
             // TODO: make sure quoted field names cannot contain null characters
-            return quotedString(result);
+            return quotedStringView(result, scratch);
         }
         else {
             // Unquoted key
@@ -1036,33 +1105,61 @@ namespace mongo {
             if (!match(*_input, ALPHA "_$")) {
                 return parseError("First character in field must be [A-Za-z$_]");
             }
-            return chars(result, "", ALPHA DIGIT "_$");
+            const char* q = _input;
+            while (q < _input_end && isFieldChar(*q)) {
+                ++q;
+            }
+            if (q >= _input_end) {
+                return parseError("Unexpected end of input");
+            }
+            *result = StringData(_input, q - _input);
+            _input = q;
+            return Status::OK();
         }
     }
 
     Status JParse::quotedString(std::string* result) {
+        StringData view;
+        Status ret = quotedStringView(&view, result);
+        if (ret == Status::OK() && view.rawData() != result->data()) {
+            result->assign(view.rawData(), view.size());
+        }
+        return ret;
+    }
+
+    Status JParse::quotedStringView(StringData* result, std::string* scratch) {
         MONGO_JSON_DEBUG("");
+        const char* quote;
         if (readToken(DOUBLEQUOTE)) {
-            Status ret = chars(result, "\"");
-            if (ret != Status::OK()) {
-                return ret;
-            }
-            if (!readToken(DOUBLEQUOTE)) {
-                return parseError("Expecting '\"'");
-            }
+            quote = DOUBLEQUOTE;
         }
         else if (readToken(SINGLEQUOTE)) {
-            Status ret = chars(result, "'");
-            if (ret != Status::OK()) {
-                return ret;
-            }
-            if (!readToken(SINGLEQUOTE)) {
-                return parseError("Expecting '''");
-            }
+            quote = SINGLEQUOTE;
         }
         else {
             return parseError("Expecting quoted string");
         }
+
+        // Most strings have no escape sequences and can be used where they are in the input.
+        const char* q = _input;
+        while (q < _input_end && *q != *quote && isPlainStringChar(*q)) {
+            ++q;
+        }
+        if (q < _input_end && *q == *quote) {
+            *result = StringData(_input, q - _input);
+            _input = q + 1;
+            return Status::OK();
+        }
+
+        scratch->clear();
+        Status ret = chars(scratch, quote);
+        if (ret != Status::OK()) {
+            return ret;
+        }
+        if (!readToken(quote)) {
+            return parseError(quote == DOUBLEQUOTE ? "Expecting '\"'" : "Expecting '''");
+        }
+        *result = StringData(*scratch);
         return Status::OK();
     }
 
@@ -1199,9 +1296,9 @@ namespace mongo {
 
     bool JParse::readField(const StringData& expectedField) {
         MONGO_JSON_DEBUG("expectedField: " << expectedField);
-        std::string nextField;
-        nextField.reserve(FIELD_RESERVE_SIZE);
-        Status ret = field(&nextField);
+        std::string scratch;
+        StringData nextField;
+        Status ret = fieldView(&nextField, &scratch);
         if (ret != Status::OK()) {
             return false;
         }
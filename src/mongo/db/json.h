@@ -349,6 +349,13 @@ namespace mongo {
              */
             Status field(std::string* result);
 
+            /**
+             * Like field(), but unless the name has escape sequences 'result' refers to it
+             * where it is in the input. Otherwise it refers to the unescaped name, which is
+             * built in 'scratch'.
+             */
+            Status fieldView(StringData* result, std::string* scratch);
+
             /*
              * STRING :
              *     " "
@@ -358,6 +365,13 @@ namespace mongo {
              */
             Status quotedString(std::string* result);
 
+            /**
+             * Like quotedString(), but unless the string has escape sequences 'result' refers
+             * to it where it is in the input. Otherwise it refers to the unescaped string,
+             * which is built in 'scratch'.
+             */
+            Status quotedStringView(StringData* result, std::string* scratch);
+
             /*
              * CHARS :
              *     CHAR
@@ -504,6 +504,17 @@ namespace JsonTests {
             }
         }; DBTEST_SHIM_TEST(CodeWScopeTests);
 
+        class CodeWScopeEmptyScopeTests {
+        public:
+            void run() {
+                BSONObjBuilder b;
+                b.appendCodeWScope( "x" , "function(){ return \"y\"; }" , BSONObj() );
+                BSONObj o = b.obj();
+                ASSERT_EQUALS( "{ \"x\" : \"function(){ return \\\"y\\\"; }\" }" ,
+                               o.jsonString() );
+            }
+        }; DBTEST_SHIM_TEST(CodeWScopeEmptyScopeTests);
+
         class TimestampTests {
         public:
             void run() {
@@ -965,6 +976,21 @@ namespace JsonTests {
             }
         }; DBTEST_SHIM_TEST(EscapeFieldName);
 
+        class EscapedAndPlainFields : public Base {
+            virtual BSONObj bson() const {
+                BSONObjBuilder b;
+                b.append( "a\tb", "c\"d" );
+                b.append( "plain", "value" );
+                b.append( "e'f", "g\\h" );
+                b.append( "x", "y\nz" );
+                return b.obj();
+            }
+            virtual string json() const {
+                return "{ \"a\\tb\" : \"c\\\"d\", 'plain' : 'value', "
+                         "\"e'f\" : 'g\\\\h', x : \"y\\nz\" }";
+            }
+        }; DBTEST_SHIM_TEST(EscapedAndPlainFields);
+
         class EscapedUnicodeToUtf8 : public Base {
             virtual BSONObj bson() const {
                 BSONObjBuilder b;
@@ -2517,6 +2543,39 @@ namespace JsonTests {
             }
         }; DBTEST_SHIM_TEST(NumericLimits);
 
+        class NumericIntLongBoundaries : public Base {
+        public:
+            void run() {
+                Base::run();
+
+                BSONObj o = fromjson(json());
+
+                ASSERT(o["intMax"].type() == NumberInt);
+                ASSERT(o["overIntMax"].type() == NumberLong);
+                ASSERT(o["intMin"].type() == NumberInt);
+                ASSERT(o["underIntMin"].type() == NumberLong);
+                ASSERT(o["digits18"].type() == NumberLong);
+                ASSERT(o["digits19"].type() == NumberLong);
+                ASSERT(o["hex"].type() == NumberDouble);
+            }
+
+            virtual BSONObj bson() const {
+                return BSON( "intMax" << 2147483647
+                             << "overIntMax" << 2147483648ll
+                             << "intMin" << -2147483647 - 1
+                             << "underIntMin" << -2147483649ll
+                             << "digits18" << -123456789012345678ll
+                             << "digits19" << 1234567890123456789ll
+                             << "hex" << 26.0
+                           );
+            }
+            virtual string json() const {
+                return "{ intMax: 2147483647, overIntMax: 2147483648, intMin: -2147483648, "
+                         "underIntMin: -2147483649, digits18: -123456789012345678, "
+                         "digits19: 1234567890123456789, hex: 0x1A }";
+            }
+        }; DBTEST_SHIM_TEST(NumericIntLongBoundaries);
+
         //Overflows double by giving it an exponent that is too large
         class NumericLimitsBad : public Bad {
             virtual string json() const {
@@ -22,6 +22,7 @@
 #include "mongo/dbtests/mock/mock_conn_registry.h"
 #include "mongo/dbtests/mock/mock_replica_set.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/timer.h"
 
 #include <set>
 #include <vector>
@@ -1416,6 +1417,113 @@ namespace mongo_test {
         monitor->startOrContinueRefresh().refreshAll();
     }
 
+    /**
+     * Turns on ReplicaSetMonitor::useParallelIsMaster for the life of the object.
+     */
+    class ParallelIsMasterScope {
+    public:
+        ParallelIsMasterScope() { ReplicaSetMonitor::useParallelIsMaster = true; }
+        ~ParallelIsMasterScope() { ReplicaSetMonitor::useParallelIsMaster = false; }
+    };
+
+    TEST_F(ReplicaSetMonitorTest, ParallelIsMasterRefreshAll) {
+        ParallelIsMasterScope parallel;
+
+        MockReplicaSet* replSet = getReplSet();
+        const vector<string> secondaries = replSet->getSecondaries();
+        replSet->kill(secondaries.front());
+
+        set<HostAndPort> seedList;
+        seedList.insert(HostAndPort(replSet->getPrimary()));
+        ReplicaSetMonitor::createIfNeeded(replSet->getSetName(), seedList);
+
+        ReplicaSetMonitorPtr monitor = ReplicaSetMonitor::get(replSet->getSetName());
+        monitor->startOrContinueRefresh().refreshAll();
+
+        ASSERT_TRUE(monitor->isPrimary(HostAndPort(replSet->getPrimary())));
+        ASSERT_TRUE(monitor->isHostUp(HostAndPort(secondaries.back())));
+        ASSERT_FALSE(monitor->isHostUp(HostAndPort(secondaries.front())));
+    }
+
+    TEST_F(ReplicaSetMonitorTest, ParallelIsMasterDoesNotWaitForSlowMember) {
+        ParallelIsMasterScope parallel;
+        const int kDelayMillis = 1000;
+
+        MockReplicaSet* replSet = getReplSet();
+        const vector<string> secondaries = replSet->getSecondaries();
+        for (size_t i = 0; i < secondaries.size(); i++)
+            replSet->getNode(secondaries[i])->setDelay(kDelayMillis);
+
+        // Seed with every member so the first scan contacts them all at once.
+        set<HostAndPort> seedList;
+        seedList.insert(HostAndPort(replSet->getPrimary()));
+        for (size_t i = 0; i < secondaries.size(); i++)
+            seedList.insert(HostAndPort(secondaries[i]));
+        ReplicaSetMonitor::createIfNeeded(replSet->getSetName(), seedList);
+
+        ReplicaSetMonitorPtr monitor = ReplicaSetMonitor::get(replSet->getSetName());
+        mongo::Timer timer;
+        const HostAndPort primary = monitor->getHostOrRefresh(
+                ReadPreferenceSetting(mongo::ReadPreference_PrimaryOnly, TagSet()));
+        const int elapsedMillis = timer.millis();
+
+        ASSERT_EQUALS(HostAndPort(replSet->getPrimary()), primary);
+        ASSERT_LESS_THAN(elapsedMillis, kDelayMillis / 2);
+
+        // Let the slow replies land before the mock servers go away.
+        monitor->startOrContinueRefresh().refreshAll();
+    }
+
+    TEST_F(ReplicaSetMonitorTest, ParallelIsMasterWithOneThread) {
+        ParallelIsMasterScope parallel;
+        const int originalMaxThreads = ReplicaSetMonitor::maxParallelIsMasterThreads;
+        ReplicaSetMonitor::maxParallelIsMasterThreads = 1;
+
+        MockReplicaSet* replSet = getReplSet();
+        const vector<string> secondaries = replSet->getSecondaries();
+        replSet->kill(secondaries.front());
+
+        set<HostAndPort> seedList;
+        seedList.insert(HostAndPort(replSet->getPrimary()));
+        for (size_t i = 0; i < secondaries.size(); i++)
+            seedList.insert(HostAndPort(secondaries[i]));
+        ReplicaSetMonitor::createIfNeeded(replSet->getSetName(), seedList);
+
+        ReplicaSetMonitorPtr monitor = ReplicaSetMonitor::get(replSet->getSetName());
+        monitor->startOrContinueRefresh().refreshAll();
+        ReplicaSetMonitor::maxParallelIsMasterThreads = originalMaxThreads;
+
+        ASSERT_TRUE(monitor->isPrimary(HostAndPort(replSet->getPrimary())));
+        ASSERT_TRUE(monitor->isHostUp(HostAndPort(secondaries.back())));
+        ASSERT_FALSE(monitor->isHostUp(HostAndPort(secondaries.front())));
+    }
+
+    TEST_F(ReplicaSetMonitorTest, ShutdownWaitsForParallelIsMaster) {
+        ParallelIsMasterScope parallel;
+
+        MockReplicaSet* replSet = getReplSet();
+        const vector<string> secondaries = replSet->getSecondaries();
+        for (size_t i = 0; i < secondaries.size(); i++)
+            replSet->getNode(secondaries[i])->setDelay(200);
+
+        set<HostAndPort> seedList;
+        seedList.insert(HostAndPort(replSet->getPrimary()));
+        for (size_t i = 0; i < secondaries.size(); i++)
+            seedList.insert(HostAndPort(secondaries[i]));
+        ReplicaSetMonitor::createIfNeeded(replSet->getSetName(), seedList);
+
+        // Returns with the calls to the slow secondaries still in progress.
+        ReplicaSetMonitorPtr monitor = ReplicaSetMonitor::get(replSet->getSetName());
+        monitor->getHostOrRefresh(
+                ReadPreferenceSetting(mongo::ReadPreference_PrimaryOnly, TagSet()));
+
+        ASSERT_OK(ReplicaSetMonitor::shutdown());
+        for (size_t i = 0; i < secondaries.size(); i++)
+            ASSERT_TRUE(monitor->isHostUp(HostAndPort(secondaries[i])));
+
+        ReplicaSetMonitor::initialize();
+    }
+
     // Stress test case for a node that is previously a primary being removed from the set.
     // This test goes through configurations with different positions for the primary node
     // in the host list returned from the isMaster command. The test here is to make sure
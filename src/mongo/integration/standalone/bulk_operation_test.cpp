@@ -884,6 +884,37 @@ namespace {
         ASSERT_EQUALS(this->c->count(TEST_NS, Query()), 7U);
     }
 
+    TYPED_TEST(BulkOperationTest, UnorderedBatchSplittingPipelined) {
+        if (!this->testSupported()) return;
+
+        this->c->setMaxWriteBatchesInFlight(4);
+        BulkOperationBuilder bulk(this->c, TEST_NS, false);
+
+        for (int i = 0; i < 2500; ++i)
+            bulk.insert(BSON("_id" << i));
+
+        bulk.insert(BSON("_id" << 1500)); // will fail
+        bulk.insert(BSON("_id" << 2500));
+
+        WriteResult result;
+        ASSERT_THROWS(
+            bulk.execute(&WriteConcern::acknowledged, &result),
+            OperationException
+        );
+
+        ASSERT_EQUALS(result.nInserted(), 2501);
+        ASSERT_EQUALS(result.writeErrors().size(), 1U);
+
+        BSONObj writeError = result.writeErrors().front();
+        ASSERT_EQUALS(writeError.getIntField("code"), 11000);
+        ASSERT_EQUALS(writeError.getIntField("index"), 2500);
+
+        ASSERT_EQUALS(this->c->count(TEST_NS, Query()), 2501U);
+
+        // The connection must be usable afterwards, with no replies left unread.
+        ASSERT_EQUALS(this->c->findOne(TEST_NS, MONGO_QUERY("_id" << 2500))["_id"].numberInt(), 2500);
+    }
+
     TYPED_TEST(BulkOperationTest, EmptyBatch) {
         if (!this->testSupported()) return;
 
@@ -977,4 +1008,76 @@ namespace {
         }
     }
 
+
+    DBClientBase* makeNewConnection(DBClientBase* originalConnection,
+                                    std::vector<DBClientBase*>* connectionAccumulator) {
+        DBClientConnection* newConn = new DBClientConnection();
+        newConn->connect(originalConnection->getServerAddress());
+        newConn->setWireVersions(originalConnection->getMinWireVersion(),
+                                 originalConnection->getMaxWireVersion());
+        connectionAccumulator->push_back(newConn);
+        return newConn;
+    }
+
+    TYPED_TEST(BulkOperationTest, InsertUnorderedParallel) {
+        if (!this->testSupported()) return;
+
+        const int n = this->c->getMaxWriteBatchSize() * 3 + 10;
+        BulkOperationBuilder bulk(this->c, TEST_NS, false);
+        for (int i = 0; i < n; ++i)
+            bulk.insert(BSON("_id" << i));
+
+        vector<DBClientBase*> connections;
+        WriteResult result;
+        bulk.executeParallel(&WriteConcern::acknowledged, &result, 3,
+                             stdx::bind(&makeNewConnection, this->c, &connections));
+
+        ASSERT_EQUALS(connections.size(), 2U);
+        for (size_t i = 0; i < connections.size(); ++i)
+            delete connections[i];
+
+        ASSERT_EQUALS(result.nInserted(), n);
+        ASSERT_FALSE(result.hasErrors());
+        ASSERT_EQUALS(this->c->count(TEST_NS, Query("{}")), static_cast<unsigned long long>(n));
+    }
+
+    TYPED_TEST(BulkOperationTest, InsertUnorderedParallelWithWriteErrors) {
+        if (!this->testSupported()) return;
+
+        const int n = this->c->getMaxWriteBatchSize() * 3 + 10;
+        BulkOperationBuilder bulk(this->c, TEST_NS, false);
+        for (int i = 0; i < n; ++i)
+            bulk.insert(BSON("_id" << i % (n - 5)));
+
+        vector<DBClientBase*> connections;
+        WriteResult result;
+        ASSERT_THROWS(
+            bulk.executeParallel(&WriteConcern::acknowledged, &result, 4,
+                                 stdx::bind(&makeNewConnection, this->c, &connections)),
+            OperationException
+        );
+        for (size_t i = 0; i < connections.size(); ++i)
+            delete connections[i];
+
+        ASSERT_EQUALS(result.nInserted(), n - 5);
+        ASSERT_EQUALS(result.writeErrors().size(), 5U);
+        ASSERT_EQUALS(this->c->count(TEST_NS, Query("{}")), static_cast<unsigned long long>(n - 5));
+    }
+
+    TYPED_TEST(BulkOperationTest, OrderedCannotExecuteParallel) {
+        if (!this->testSupported()) return;
+
+        BulkOperationBuilder bulk(this->c, TEST_NS, true);
+        bulk.insert(BSON("a" << 1));
+
+        vector<DBClientBase*> connections;
+        WriteResult result;
+        ASSERT_THROWS(
+            bulk.executeParallel(&WriteConcern::acknowledged, &result, 2,
+                                 stdx::bind(&makeNewConnection, this->c, &connections)),
+            UserException
+        );
+        ASSERT_TRUE(connections.empty());
+    }
+
 } // namespace
@@ -1044,6 +1044,52 @@ namespace {
         ASSERT_EQUALS(docs.size(), 3U);
     }
 
+    TEST_F(DBClientTest, PrefetchCursor) {
+        vector<BSONObj> inserted;
+        for (int i = 0; i < 100; ++i)
+            inserted.push_back(BSON("_id" << i));
+        c.insert(TEST_NS, inserted);
+
+        auto_ptr<DBClientCursor> cursor =
+            c.query(TEST_NS, Query("{}").sort("_id"), 0, 0, 0, 0, 7);
+        cursor->enablePrefetch();
+
+        int expected = 0;
+        while (cursor->more())
+            ASSERT_EQUALS(expected++, cursor->next()["_id"].numberInt());
+        ASSERT_EQUALS(100, expected);
+    }
+
+    TEST_F(DBClientTest, PrefetchCursorWithLimit) {
+        vector<BSONObj> inserted;
+        for (int i = 0; i < 100; ++i)
+            inserted.push_back(BSON("_id" << i));
+        c.insert(TEST_NS, inserted);
+
+        auto_ptr<DBClientCursor> cursor =
+            c.query(TEST_NS, Query("{}"), 30, 0, 0, 0, 7);
+        cursor->enablePrefetch(2);
+        ASSERT_EQUALS(30, cursor->itcount());
+    }
+
+    TEST_F(DBClientTest, PrefetchCursorDestroyedEarly) {
+        vector<BSONObj> inserted;
+        for (int i = 0; i < 100; ++i)
+            inserted.push_back(BSON("_id" << i));
+        c.insert(TEST_NS, inserted);
+
+        {
+            auto_ptr<DBClientCursor> cursor =
+                c.query(TEST_NS, Query("{}"), 0, 0, 0, 0, 7);
+            cursor->enablePrefetch();
+            ASSERT_TRUE(cursor->more());
+            cursor->next();
+        }
+
+        // The outstanding getMore reply must not be mistaken for this one.
+        ASSERT_EQUALS(100U, c.count(TEST_NS));
+    }
+
     TEST_F(DBClientTest, NoGetMoreLimit) {
         c.insert(TEST_NS, BSON("num" << 1));
         c.insert(TEST_NS, BSON("num" << 2));
@@ -22,6 +22,7 @@
 
 #include "mongo/integration/integration_test.h"
 #include "mongo/client/dbclient.h"
+#include "mongo/util/md5.hpp"
 
 using boost::scoped_ptr;
 using std::auto_ptr;
@@ -107,6 +108,34 @@ namespace {
         ASSERT_EQUALS(gf.getNumChunks(), DATA_LEN);
     }
 
+    TEST_F(GridFSTest, ClientMD5MatchesServerMD5) {
+        _gfs->setChunkSize(5);
+        BSONObj serverResult = _gfs->storeFile(DATA, DATA_LEN, DATA_NAME);
+
+        _gfs->setClientMD5(true);
+        BSONObj clientResult = _gfs->storeFile(DATA, DATA_LEN, OTHER_NAME);
+
+        ASSERT_EQUALS(clientResult["md5"].String(), serverResult["md5"].String());
+        ASSERT_EQUALS(clientResult["length"].numberInt(), DATA_LEN);
+    }
+
+    TEST_F(GridFSTest, GridFileBuilderClientMD5) {
+        _gfs->setChunkSize(3);
+        _gfs->setClientMD5(true);
+
+        GridFileBuilder gfb(_gfs.get());
+        for (int i=0; i<DATA_LEN; i+=2)
+            gfb.appendChunk(DATA + i, min(2, DATA_LEN - i));
+        BSONObj result = gfb.buildFile(DATA_NAME);
+
+        ASSERT_EQUALS(result["md5"].String(), md5simpledigest(DATA, DATA_LEN));
+
+        GridFile gf = _gfs->findFileByName(DATA_NAME);
+        stringstream ss;
+        gf.write(ss);
+        ASSERT_EQUALS(ss.str(), DATA);
+    }
+
     TEST_F(GridFSTest, FindFile) {
         const char content_type[] = "text";
         BSONObj result;
@@ -181,6 +210,88 @@ namespace {
         ASSERT_EQUALS(ss.str(), DATA);
     }
 
+    TEST_F(GridFSTest, WriteToStreamMultipleChunks) {
+        _gfs->setChunkSize(3);
+        _gfs->setReadBatchSize(2);
+        _gfs->storeFile(DATA, DATA_LEN, DATA_NAME);
+
+        GridFile gf = _gfs->findFileByName(DATA_NAME);
+        stringstream ss;
+        gf.write(ss);
+
+        ASSERT_EQUALS(ss.str(), DATA);
+    }
+
+    TEST_F(GridFSTest, ReadRangeOfChunks) {
+        _gfs->setChunkSize(4);
+        _gfs->storeFile(DATA, DATA_LEN, DATA_NAME);
+
+        GridFile gf = _gfs->findFileByName(DATA_NAME);
+        GridFileReader reader(gf, _conn.get(), 1, 3);
+
+        string read;
+        while (reader.more()) {
+            int len;
+            const char* data = reader.next().data(len);
+            read.append(data, len);
+        }
+
+        ASSERT_EQUALS(read, string(DATA + 4, 8));
+    }
+
+    TEST_F(GridFSTest, ReadMissingChunk) {
+        _gfs->setChunkSize(4);
+        _gfs->storeFile(DATA, DATA_LEN, DATA_NAME);
+
+        GridFile gf = _gfs->findFileByName(DATA_NAME);
+        _conn->remove(TEST_DB + ".fs.chunks", BSON("n" << 2));
+
+        stringstream ss;
+        ASSERT_THROWS(gf.write(ss), UserException);
+    }
+
+    TEST_F(GridFSTest, InputStream) {
+        _gfs->setChunkSize(5);
+        _gfs->storeFile(DATA, DATA_LEN, DATA_NAME);
+
+        GridFile gf = _gfs->findFileByName(DATA_NAME);
+        GridFileInputStream in(gf);
+        stringstream ss;
+        ss << in.rdbuf();
+
+        ASSERT_EQUALS(ss.str(), DATA);
+    }
+
+    TEST_F(GridFSTest, WriteParallel) {
+        _gfs->setChunkSize(3);
+        _gfs->storeFile(DATA, DATA_LEN, DATA_NAME);
+
+        GridFile gf = _gfs->findFileByName(DATA_NAME);
+
+#if defined(_WIN32)
+        char tmp_path[MAX_PATH - 14];
+        GetTempPathA(MAX_PATH, tmp_path);
+        char tmp_name[MAX_PATH];
+        GetTempFileNameA(tmp_path, "tmp", 0U, tmp_name);
+#else
+        char tmp_name[] = "/tmp/tmp.XXXXXXXX";
+        int tmp_fd = mkstemp(tmp_name);
+        if (tmp_fd == -1)
+            std::abort();
+        else
+            close(tmp_fd);
+#endif
+
+        DBClientConnectionPool pool;
+        ASSERT_EQUALS(gf.writeParallel(tmp_name, pool, HostAndPort(server().uri()), 4), UDATA_LEN);
+        ASSERT_EQUALS(pool.getNumAvailableConnections(HostAndPort(server().uri())), 4U);
+
+        ifstream written_file(tmp_name, ios::binary);
+        stringstream written_data;
+        written_data << written_file.rdbuf();
+        ASSERT_EQUALS(written_data.str(), DATA);
+    }
+
     TEST_F(GridFSTest, RemoveFile) {
         _gfs->storeFile(DATA, DATA_LEN, DATA_NAME);
         _gfs->storeFile(OTHER, DATA_LEN, OTHER_NAME);
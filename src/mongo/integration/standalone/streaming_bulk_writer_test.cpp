@@ -0,0 +1,145 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/integration/integration_test.h"
+
+#include "mongo/client/dbclient.h"
+#include "mongo/client/streaming_bulk_writer.h"
+#include "mongo/client/write_result.h"
+
+namespace {
+
+    using std::string;
+
+    using namespace mongo;
+    using namespace mongo::integration;
+
+    const string TEST_NS = "test.streaming_bulk_writer";
+
+    class StreamingBulkWriterTest : public StandaloneTest {
+    public:
+        StreamingBulkWriterTest() {
+            c.connect(server().uri());
+            c.dropCollection(TEST_NS);
+        }
+
+        // More than fit in one batch, so that several are written.
+        int numDocuments() {
+            return c.getMaxWriteBatchSize() * 2 + 10;
+        }
+
+        DBClientConnection c;
+    };
+
+    TEST_F(StreamingBulkWriterTest, InsertsManyBatches) {
+        const int n = numDocuments();
+
+        StreamingBulkWriter writer(&c, TEST_NS, false, &WriteConcern::acknowledged);
+        for (int i = 0; i < n; ++i)
+            writer.insert(BSON("_id" << i));
+        ASSERT_EQUALS(writer.numEnqueued(), static_cast<size_t>(n));
+
+        WriteResult result;
+        writer.finish(&result);
+
+        ASSERT_EQUALS(result.nInserted(), n);
+        ASSERT_FALSE(result.hasErrors());
+        ASSERT_EQUALS(c.count(TEST_NS, Query("{}")), static_cast<unsigned long long>(n));
+    }
+
+    TEST_F(StreamingBulkWriterTest, CopiesDocumentsNotOwned) {
+        const int n = numDocuments();
+
+        StreamingBulkWriter writer(&c, TEST_NS, false, &WriteConcern::acknowledged);
+        for (int i = 0; i < n; ++i) {
+            // The inserted document points into a buffer freed at the end of the iteration.
+            BSONObj wrapper = BSON("doc" << BSON("_id" << i << "x" << string(100, 'x')));
+            writer.insert(wrapper["doc"].Obj());
+        }
+
+        WriteResult result;
+        writer.finish(&result);
+
+        ASSERT_EQUALS(result.nInserted(), n);
+        ASSERT_EQUALS(c.count(TEST_NS, BSON("x" << string(100, 'x'))),
+                      static_cast<unsigned long long>(n));
+    }
+
+    TEST_F(StreamingBulkWriterTest, MixedOperations) {
+        StreamingBulkWriter writer(&c, TEST_NS, true, &WriteConcern::acknowledged);
+        writer.insert(BSON("_id" << 1 << "a" << 1));
+        writer.insert(BSON("_id" << 2 << "a" << 1));
+        writer.update(BSON("a" << 1), BSON("$set" << BSON("b" << 1)), false, true);
+        writer.update(BSON("_id" << 3), BSON("$set" << BSON("a" << 2)), true);
+        writer.remove(BSON("_id" << 1), true);
+
+        WriteResult result;
+        writer.finish(&result);
+
+        ASSERT_EQUALS(result.nInserted(), 2);
+        ASSERT_EQUALS(result.nMatched(), 2);
+        ASSERT_EQUALS(result.nUpserted(), 1);
+        ASSERT_EQUALS(result.nRemoved(), 1);
+        ASSERT_EQUALS(result.upserted().size(), 1U);
+        ASSERT_EQUALS(result.upserted().front()["index"].numberInt(), 3);
+        ASSERT_EQUALS(c.count(TEST_NS, Query("{}")), 2U);
+    }
+
+    TEST_F(StreamingBulkWriterTest, UnorderedContinuesPastWriteErrors) {
+        const int n = numDocuments();
+
+        StreamingBulkWriter writer(&c, TEST_NS, false, &WriteConcern::acknowledged);
+        for (int i = 0; i < n; ++i)
+            writer.insert(BSON("_id" << i % (n - 5)));
+
+        WriteResult result;
+        ASSERT_THROWS(writer.finish(&result), OperationException);
+
+        ASSERT_EQUALS(result.nInserted(), n - 5);
+        ASSERT_EQUALS(result.writeErrors().size(), 5U);
+        ASSERT_EQUALS(result.writeErrors().front()["index"].numberInt(), n - 5);
+        ASSERT_EQUALS(c.count(TEST_NS, Query("{}")), static_cast<unsigned long long>(n - 5));
+    }
+
+    TEST_F(StreamingBulkWriterTest, OrderedStopsAtWriteError) {
+        const int n = numDocuments();
+
+        StreamingBulkWriter writer(&c, TEST_NS, true, &WriteConcern::acknowledged);
+        writer.insert(BSON("_id" << 0));
+        writer.insert(BSON("_id" << 0));
+
+        // The error is thrown once the batch holding it has been written.
+        bool threw = false;
+        try {
+            for (int i = 1; i < n; ++i)
+                writer.insert(BSON("_id" << i));
+        }
+        catch (const OperationException&) {
+            threw = true;
+        }
+        ASSERT_TRUE(threw);
+
+        WriteResult result;
+        ASSERT_THROWS(writer.finish(&result), OperationException);
+
+        ASSERT_EQUALS(result.nInserted(), 1);
+        ASSERT_EQUALS(result.writeErrors().size(), 1U);
+        ASSERT_EQUALS(result.writeErrors().front()["index"].numberInt(), 1);
+        ASSERT_EQUALS(c.count(TEST_NS, Query("{}")), 1U);
+    }
+
+} // namespace
@@ -0,0 +1,157 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/logger/async_appender.h"
+
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace logger {
+
+    AsyncAppender::Entry::Entry()
+        : date(0)
+        , severity(LogSeverity::Log())
+        , component(LogComponent::kDefault)
+    {}
+
+    AsyncAppender::AsyncAppender(AppenderAutoPtr appender,
+                                 size_t queueSize,
+                                 OverflowPolicy policy)
+        : _appender(appender.release())
+        , _queueSize(std::max<size_t>(queueSize, 1))
+        , _policy(policy)
+        , _queue(_queueSize)
+        , _numQueued(0)
+        , _writing(_queueSize)
+        , _numAppended(0)
+        , _numWritten(0)
+        , _numDropped(0)
+        , _numDroppedUnreported(0)
+        , _stopping(false)
+        , _stopped(false) {
+
+        _thread.reset(new boost::thread(boost::bind(&AsyncAppender::_run, this)));
+    }
+
+    AsyncAppender::~AsyncAppender() {
+        stop();
+    }
+
+    Status AsyncAppender::append(const Event& event) {
+        boost::unique_lock<boost::mutex> lk(_mutex);
+
+        if (_numQueued == _queueSize && !_stopped) {
+            if (_policy == kDrop) {
+                ++_numDropped;
+                ++_numDroppedUnreported;
+                return Status::OK();
+            }
+            while (_numQueued == _queueSize && !_stopped)
+                _queueNotFull.wait(lk);
+        }
+
+        if (_stopped)
+            return _appender->append(event);
+
+        Entry& entry = _queue[_numQueued++];
+        entry.date = event.getDate();
+        entry.severity = event.getSeverity();
+        entry.component = event.getComponent();
+        entry.contextName.assign(event.getContextName().rawData(),
+                                 event.getContextName().size());
+        entry.message.assign(event.getMessage().rawData(), event.getMessage().size());
+        ++_numAppended;
+
+        if (_numQueued == 1)
+            _queueNotEmpty.notify_one();
+        return Status::OK();
+    }
+
+    void AsyncAppender::flush() {
+        boost::unique_lock<boost::mutex> lk(_mutex);
+        const uint64_t target = _numAppended;
+        while (_numWritten < target && !_stopped)
+            _written.wait(lk);
+    }
+
+    void AsyncAppender::stop() {
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            _stopping = true;
+            _queueNotEmpty.notify_one();
+        }
+        _thread->join();
+    }
+
+    long long AsyncAppender::droppedCount() const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        return _numDropped;
+    }
+
+    void AsyncAppender::_run() {
+        boost::unique_lock<boost::mutex> lk(_mutex);
+
+        while (true) {
+            while (_numQueued == 0 && _numDroppedUnreported == 0 && !_stopping)
+                _queueNotEmpty.wait(lk);
+            if (_numQueued == 0 && _numDroppedUnreported == 0)
+                break;
+
+            // Take everything queued, and let the logging threads carry on while it is written.
+            _queue.swap(_writing);
+            const size_t numWriting = _numQueued;
+            const long long numDropped = _numDroppedUnreported;
+            _numQueued = 0;
+            _numDroppedUnreported = 0;
+            _queueNotFull.notify_all();
+            lk.unlock();
+
+            for (size_t i = 0; i < numWriting; ++i) {
+                const Entry& entry = _writing[i];
+                _appender->append(MessageEventEphemeral(entry.date,
+                                                        entry.severity,
+                                                        entry.component,
+                                                        entry.contextName,
+                                                        entry.message));
+            }
+
+            if (numDropped > 0) {
+                const std::string message = str::stream()
+                    << numDropped << " log messages were dropped because the log queue was full";
+                _appender->append(MessageEventEphemeral(curTimeMillis64(),
+                                                        LogSeverity::Warning(),
+                                                        "",
+                                                        message));
+            }
+
+            lk.lock();
+            _numWritten += numWriting;
+            _written.notify_all();
+        }
+
+        _stopped = true;
+        _queueNotFull.notify_all();
+        _written.notify_all();
+    }
+
+}  // namespace logger
+}  // namespace mongo
@@ -0,0 +1,121 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/client/export_macros.h"
+#include "mongo/logger/appender.h"
+#include "mongo/logger/message_event.h"
+#include "mongo/platform/cstdint.h"
+
+namespace boost {
+    class thread;
+}  // namespace boost
+
+namespace mongo {
+namespace logger {
+
+    /**
+     * Appender that hands messages to another appender on a background thread, so that the
+     * threads doing the logging do not wait for the other appender's I/O.
+     *
+     * append() copies the message into a bounded queue and returns. The background thread
+     * takes everything queued at once and passes it to the wrapped appender in order. When the
+     * queue is full, append() either waits for room or drops the message, depending on the
+     * OverflowPolicy; the number of dropped messages is logged once there is room again.
+     *
+     * Errors from the wrapped appender are ignored, since there is no caller to return them to.
+     *
+     * After stop(), which the destructor calls, messages are passed to the wrapped appender
+     * directly on the logging thread.
+     */
+    class MONGO_CLIENT_API AsyncAppender : public Appender<MessageEventEphemeral> {
+        MONGO_DISALLOW_COPYING(AsyncAppender);
+    public:
+        typedef std::auto_ptr<Appender<MessageEventEphemeral> > AppenderAutoPtr;
+
+        enum OverflowPolicy {
+            kBlock,
+            kDrop
+        };
+
+        /**
+         * Starts a background thread writing to 'appender', with room for 'queueSize' messages
+         * waiting to be written.
+         */
+        AsyncAppender(AppenderAutoPtr appender, size_t queueSize, OverflowPolicy policy = kBlock);
+        virtual ~AsyncAppender();
+
+        virtual Status append(const Event& event);
+
+        /** Waits until every message appended before the call has been written. */
+        void flush();
+
+        /** Writes every queued message and stops the background thread. */
+        void stop();
+
+        /** @return the number of messages dropped because the queue was full. */
+        long long droppedCount() const;
+
+    private:
+        // A queued message, which owns copies of the event's strings.
+        struct Entry {
+            Entry();
+
+            uint64_t date;
+            LogSeverity severity;
+            LogComponent component;
+            std::string contextName;
+            std::string message;
+        };
+
+        void _run();
+
+        const boost::scoped_ptr<Appender<MessageEventEphemeral> > _appender;
+        const size_t _queueSize;
+        const OverflowPolicy _policy;
+
+        mutable boost::mutex _mutex;
+        boost::condition_variable _queueNotEmpty;
+        boost::condition_variable _queueNotFull;
+        boost::condition_variable _written;
+
+        // Both hold _queueSize entries, whose strings keep their buffers between messages.
+        // The first _numQueued entries of _queue are waiting to be written. _writing is only
+        // used by the background thread, and is swapped with _queue to take a batch.
+        std::vector<Entry> _queue;
+        size_t _numQueued;
+        std::vector<Entry> _writing;
+
+        uint64_t _numAppended;
+        uint64_t _numWritten;
+        long long _numDropped;
+        long long _numDroppedUnreported;
+
+        bool _stopping;
+        bool _stopped;
+        boost::scoped_ptr<boost::thread> _thread;
+    };
+
+}  // namespace logger
+}  // namespace mongo
@@ -0,0 +1,175 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/logger/async_appender.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <string>
+#include <vector>
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace {
+
+    using mongo::Status;
+    using mongo::logger::Appender;
+    using mongo::logger::AsyncAppender;
+    using mongo::logger::LogSeverity;
+    using mongo::logger::MessageEventEphemeral;
+
+    // Records the messages appended to it. While closed, append() waits to be opened.
+    class GatedAppender : public Appender<MessageEventEphemeral> {
+    public:
+        GatedAppender() : _open(true), _numWaiting(0) {}
+
+        virtual Status append(const MessageEventEphemeral& event) {
+            boost::unique_lock<boost::mutex> lk(_mutex);
+            ++_numWaiting;
+            _changed.notify_all();
+            while (!_open)
+                _changed.wait(lk);
+            --_numWaiting;
+
+            _messages.push_back(event.getMessage().toString());
+            _threads.push_back(boost::this_thread::get_id());
+            return Status::OK();
+        }
+
+        void setOpen(bool open) {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            _open = open;
+            _changed.notify_all();
+        }
+
+        // Waits until a call to append() is held up by the gate.
+        void waitForWaiter() {
+            boost::unique_lock<boost::mutex> lk(_mutex);
+            while (_numWaiting == 0)
+                _changed.wait(lk);
+        }
+
+        std::vector<std::string> messages() {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            return _messages;
+        }
+
+        std::vector<boost::thread::id> threads() {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            return _threads;
+        }
+
+    private:
+        boost::mutex _mutex;
+        boost::condition_variable _changed;
+        bool _open;
+        int _numWaiting;
+        std::vector<std::string> _messages;
+        std::vector<boost::thread::id> _threads;
+    };
+
+    void appendMessage(AsyncAppender* appender, const std::string& message) {
+        ASSERT_OK(appender->append(MessageEventEphemeral(0ULL, LogSeverity::Log(), "", message)));
+    }
+
+    TEST(AsyncAppender, WritesInOrderOnAnotherThread) {
+        GatedAppender* gated = new GatedAppender;
+        AsyncAppender appender(AsyncAppender::AppenderAutoPtr(gated), 8);
+
+        // The messages are copied, so the buffer they came from may be reused straight away.
+        std::string buffer;
+        for (int i = 0; i < 100; ++i) {
+            buffer = mongo::str::stream() << "message " << i;
+            appendMessage(&appender, buffer);
+        }
+        appender.flush();
+
+        const std::vector<std::string> messages = gated->messages();
+        ASSERT_EQUALS(100U, messages.size());
+        for (int i = 0; i < 100; ++i)
+            ASSERT_EQUALS(std::string(mongo::str::stream() << "message " << i), messages[i]);
+        ASSERT_TRUE(gated->threads()[0] != boost::this_thread::get_id());
+        ASSERT_EQUALS(0, appender.droppedCount());
+    }
+
+    TEST(AsyncAppender, DropsMessagesWhenFull) {
+        GatedAppender* gated = new GatedAppender;
+        AsyncAppender appender(AsyncAppender::AppenderAutoPtr(gated), 2, AsyncAppender::kDrop);
+
+        // Hold up the background thread writing the first message, then fill the queue.
+        gated->setOpen(false);
+        appendMessage(&appender, "1");
+        gated->waitForWaiter();
+        appendMessage(&appender, "2");
+        appendMessage(&appender, "3");
+        appendMessage(&appender, "4");
+        appendMessage(&appender, "5");
+        ASSERT_EQUALS(2, appender.droppedCount());
+
+        gated->setOpen(true);
+        appender.flush();
+
+        const std::vector<std::string> messages = gated->messages();
+        ASSERT_EQUALS(4U, messages.size());
+        ASSERT_EQUALS("1", messages[0]);
+        ASSERT_EQUALS("2", messages[1]);
+        ASSERT_EQUALS("3", messages[2]);
+        ASSERT_EQUALS("2 log messages were dropped because the log queue was full", messages[3]);
+    }
+
+    TEST(AsyncAppender, BlocksWhenFull) {
+        GatedAppender* gated = new GatedAppender;
+        AsyncAppender appender(AsyncAppender::AppenderAutoPtr(gated), 1, AsyncAppender::kBlock);
+
+        gated->setOpen(false);
+        appendMessage(&appender, "1");
+        gated->waitForWaiter();
+        appendMessage(&appender, "2");
+
+        // The queue is full, so this waits until the background thread takes "2".
+        boost::thread blocked(boost::bind(&appendMessage, &appender, "3"));
+        ASSERT_FALSE(blocked.timed_join(boost::posix_time::milliseconds(50)));
+
+        gated->setOpen(true);
+        blocked.join();
+        appender.flush();
+
+        const std::vector<std::string> messages = gated->messages();
+        ASSERT_EQUALS(3U, messages.size());
+        ASSERT_EQUALS("1", messages[0]);
+        ASSERT_EQUALS("2", messages[1]);
+        ASSERT_EQUALS("3", messages[2]);
+        ASSERT_EQUALS(0, appender.droppedCount());
+    }
+
+    TEST(AsyncAppender, StopWritesQueuedMessagesThenAppendsDirectly) {
+        GatedAppender* gated = new GatedAppender;
+        AsyncAppender appender(AsyncAppender::AppenderAutoPtr(gated), 16);
+
+        appendMessage(&appender, "1");
+        appendMessage(&appender, "2");
+        appender.stop();
+        ASSERT_EQUALS(2U, gated->messages().size());
+
+        appendMessage(&appender, "3");
+        ASSERT_EQUALS(3U, gated->messages().size());
+        ASSERT_TRUE(gated->threads()[2] == boost::this_thread::get_id());
+
+        appender.flush();
+        appender.stop();
+    }
+
+}  // namespace
@@ -37,7 +37,8 @@ namespace mongo {
         }
 
 
-        void encode( stringstream& ss , const char * data , int size ) {
+        template <typename Stream>
+        void encodeTo( Stream& ss , const char * data , int size ) {
             for ( int i=0; i<size; i+=3 ) {
                 int left = size - i;
                 const unsigned char * start = (const unsigned char*)data + i;
@@ -77,10 +78,19 @@ namespace mongo {
         }
 
 
+        void encode( stringstream& ss , const char * data , int size ) {
+            encodeTo( ss , data , size );
+        }
+
+        void encode( StringBuilder& sb , const char * data , int size ) {
+            encodeTo( sb , data , size );
+        }
+
+
         string encode( const char * data , int size ) {
-            stringstream ss;
-            encode( ss , data ,size );
-            return ss.str();
+            StringBuilder sb;
+            encode( sb , data , size );
+            return sb.str();
         }
 
         string encode( const string& s ) {
@@ -23,6 +23,8 @@
 
 #include <boost/scoped_array.hpp>
 
+#include "mongo/bson/util/builder.h"
+
 namespace mongo {
     namespace base64 {
 
@@ -59,6 +61,7 @@ namespace mongo {
 
 
         void encode( std::stringstream& ss , const char * data , int size );
+        void encode( StringBuilder& sb , const char * data , int size );
         std::string encode( const char * data , int size );
         std::string encode( const std::string& s );
 
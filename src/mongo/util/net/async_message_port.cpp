@@ -0,0 +1,192 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/async_message_port.h"
+
+#include <boost/bind.hpp>
+#include <boost/thread/locks.hpp>
+#include <vector>
+
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    AsyncMessagingPort::Reply::Reply()
+        : _ready(false)
+        , _status(Status::OK())
+    {}
+
+    Status AsyncMessagingPort::Reply::wait(Message* response) {
+        boost::unique_lock<boost::mutex> lk(_mutex);
+        while (!_ready)
+            _readyCondition.wait(lk);
+
+        if (_status.isOK())
+            *response = _response;
+        return _status;
+    }
+
+    bool AsyncMessagingPort::Reply::isReady() const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        return _ready;
+    }
+
+    void AsyncMessagingPort::Reply::_complete(const Status& status, Message& response) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        _status = status;
+        if (status.isOK())
+            _response = response;
+        _ready = true;
+        _readyCondition.notify_all();
+    }
+
+    AsyncMessagingPort::AsyncMessagingPort(const boost::shared_ptr<MessagingPort>& port)
+        : _port(port)
+        , _failure(Status::OK())
+        , _dispatcher(boost::bind(&AsyncMessagingPort::_dispatch, this))
+    {}
+
+    AsyncMessagingPort::~AsyncMessagingPort() {
+        shutdown();
+    }
+
+    boost::shared_ptr<AsyncMessagingPort::Reply> AsyncMessagingPort::call(Message& toSend) {
+        boost::shared_ptr<Reply> reply(new Reply());
+        call(toSend, boost::bind(&Reply::_complete, reply, _1, _2));
+        return reply;
+    }
+
+    void AsyncMessagingPort::call(Message& toSend, const ReplyCallback& callback) {
+        toSend.header().setId(nextMessageId());
+        toSend.header().setResponseTo(0);
+        const MSGID id = toSend.header().getId();
+
+        Status failure = Status::OK();
+        {
+            // Registered before sending, since the reply may beat send() back.
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            if (_failure.isOK())
+                _pending[id] = callback;
+            else
+                failure = _failure;
+        }
+
+        if (failure.isOK()) {
+            try {
+                _send(toSend);
+                return;
+            }
+            catch (const SocketException& e) {
+                failure = Status(ErrorCodes::HostUnreachable, e.toString());
+            }
+
+            // Unless the dispatcher has already failed it, the request is still ours to fail.
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            if (_pending.erase(id) == 0)
+                return;
+        }
+
+        Message empty;
+        callback(failure, empty);
+    }
+
+    void AsyncMessagingPort::say(Message& toSend) {
+        toSend.header().setId(nextMessageId());
+        toSend.header().setResponseTo(0);
+        _send(toSend);
+    }
+
+    void AsyncMessagingPort::shutdown() {
+        _failAll(Status(ErrorCodes::ShutdownInProgress, "messaging port shut down"));
+        _port->shutdown();
+
+        // Replies are delivered on the dispatcher, which must not wait on itself.
+        if (_dispatcher.joinable() && boost::this_thread::get_id() != _dispatcher.get_id())
+            _dispatcher.join();
+    }
+
+    size_t AsyncMessagingPort::getNumPending() const {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        return _pending.size();
+    }
+
+    void AsyncMessagingPort::_dispatch() {
+        const std::string remote = _port->psock->remoteString();
+
+        while (true) {
+            Message response;
+            if (!_port->recv(response)) {
+                _failAll(Status(ErrorCodes::HostUnreachable,
+                                str::stream() << "connection to " << remote << " failed"));
+                return;
+            }
+
+            const MSGID responseTo = response.header().getResponseTo();
+            ReplyCallback callback;
+            {
+                boost::lock_guard<boost::mutex> lk(_mutex);
+                PendingMap::iterator it = _pending.find(responseTo);
+                if (it != _pending.end()) {
+                    callback = it->second;
+                    _pending.erase(it);
+                }
+            }
+
+            if (!callback) {
+                warning() << "dropping reply from " << remote << " to unknown request "
+                          << responseTo;
+                continue;
+            }
+
+            try {
+                callback(Status::OK(), response);
+            }
+            catch (const std::exception& e) {
+                warning() << "reply callback for request " << responseTo << " threw: "
+                          << e.what();
+            }
+        }
+    }
+
+    void AsyncMessagingPort::_failAll(const Status& status) {
+        std::vector<ReplyCallback> failed;
+        Status failure = Status::OK();
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            if (_failure.isOK())
+                _failure = status;
+            failure = _failure;
+            for (PendingMap::iterator it = _pending.begin(); it != _pending.end(); ++it)
+                failed.push_back(it->second);
+            _pending.clear();
+        }
+
+        for (size_t i = 0; i < failed.size(); ++i) {
+            Message empty;
+            failed[i](failure, empty);
+        }
+    }
+
+    void AsyncMessagingPort::_send(Message& toSend) {
+        boost::lock_guard<boost::mutex> lk(_sendMutex);
+        _port->sendMessage(toSend);
+    }
+
+} // namespace mongo
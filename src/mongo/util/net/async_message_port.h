@@ -0,0 +1,146 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <map>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/message_port.h"
+
+namespace mongo {
+
+    /**
+     * Multiplexes many outstanding requests over one MessagingPort.
+     *
+     * MessagingPort::call expects every reply to answer the request sent just before it. Here
+     * any number of threads may have requests outstanding at once: a dispatcher thread reads
+     * every reply off the socket and hands it to whoever is waiting on the request it names in
+     * responseTo, either through a Reply handle or a callback.
+     *
+     * Once the AsyncMessagingPort is constructed nothing else may read from the port.
+     */
+    class AsyncMessagingPort {
+        MONGO_DISALLOW_COPYING(AsyncMessagingPort);
+    public:
+        /**
+         * Called with the reply to a request, or with an error status and an empty message if
+         * the port failed or was shut down first. Runs on the dispatcher thread, so it must not
+         * block on other replies from the same port.
+         */
+        typedef stdx::function<void (const Status&, Message&)> ReplyCallback;
+
+        /**
+         * The pending reply to a request, shared between the caller and the dispatcher.
+         */
+        class Reply {
+            MONGO_DISALLOW_COPYING(Reply);
+        public:
+            Reply();
+
+            /**
+             * Blocks until the reply has arrived or the port has failed. On success the reply
+             * is moved into 'response', which must be empty; wait() may therefore only
+             * succeed once.
+             */
+            Status wait(Message* response);
+
+            /** @return true if wait() would not block. */
+            bool isReady() const;
+
+        private:
+            friend class AsyncMessagingPort;
+
+            void _complete(const Status& status, Message& response);
+
+            mutable boost::mutex _mutex;
+            boost::condition_variable _readyCondition;
+            bool _ready;
+            Status _status;
+            Message _response;
+        };
+
+        /**
+         * Starts the dispatcher. The port must not be shared with any other reader, and its
+         * handshake must be complete. The dispatcher waits on the socket whenever no reply is
+         * due, so the port should not have a socket timeout.
+         */
+        explicit AsyncMessagingPort(const boost::shared_ptr<MessagingPort>& port);
+
+        /**
+         * Shuts down the port, failing any outstanding requests. Must not be called from a
+         * ReplyCallback.
+         */
+        ~AsyncMessagingPort();
+
+        /**
+         * Sends 'toSend' with a fresh request id and returns a handle to its reply.
+         */
+        boost::shared_ptr<Reply> call(Message& toSend);
+
+        /**
+         * Sends 'toSend' with a fresh request id and arranges for 'callback' to receive its
+         * reply. If the port fails first, including during the send itself, the callback is
+         * run with the error instead; it is run exactly once either way.
+         */
+        void call(Message& toSend, const ReplyCallback& callback);
+
+        /**
+         * Sends a message that gets no reply, such as OP_KILL_CURSORS. Throws SocketException
+         * if the send fails.
+         */
+        void say(Message& toSend);
+
+        /**
+         * Closes the socket and fails all outstanding and future requests. Called by the
+         * destructor.
+         */
+        void shutdown();
+
+        /** @return the number of requests still waiting on a reply. */
+        size_t getNumPending() const;
+
+    private:
+        typedef std::map<MSGID, ReplyCallback> PendingMap;
+
+        // The dispatcher thread: routes replies by responseTo until the port fails.
+        void _dispatch();
+
+        // Marks the port failed and fails every outstanding request with 'status'.
+        void _failAll(const Status& status);
+
+        void _send(Message& toSend);
+
+        const boost::shared_ptr<MessagingPort> _port;
+
+        // Serializes writes to the socket.
+        boost::mutex _sendMutex;
+
+        // Guards _pending and _failure.
+        mutable boost::mutex _mutex;
+        PendingMap _pending;
+        Status _failure;
+
+        boost::thread _dispatcher;
+    };
+
+} // namespace mongo
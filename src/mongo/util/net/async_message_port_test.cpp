@@ -0,0 +1,205 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/async_message_port.h"
+
+#include <boost/bind.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/types.h>
+#endif
+
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using namespace mongo;
+
+#ifndef _WIN32
+    std::string payload(const Message& m) {
+        return std::string(m.header().data(), m.header().dataLen());
+    }
+
+    void setPayload(Message* m, const std::string& text) {
+        m->setData(dbMsg, text.data(), text.size());
+    }
+
+    // Replies to each request with its own payload, from its own thread.
+    void echo(MessagingPort* server, int count) {
+        for (int i = 0; i < count; ++i) {
+            Message request;
+            if (!server->recv(request))
+                return;
+
+            Message response;
+            setPayload(&response, payload(request));
+            server->reply(request, response);
+        }
+    }
+
+    void callAndCheck(AsyncMessagingPort* client, int n, bool* ok) {
+        Message request;
+        setPayload(&request, std::string(n + 1, 'a' + n));
+
+        Message response;
+        *ok = client->call(request)->wait(&response).isOK() &&
+              payload(response) == std::string(n + 1, 'a' + n);
+    }
+
+    void recordReply(std::string* out, const Status& status, Message& response) {
+        *out = status.isOK() ? payload(response) : status.reason();
+    }
+
+    class AsyncMessagingPortTest : public unittest::Test {
+    protected:
+        void setUp() {
+            int socks[2];
+            ASSERT_EQUALS(0, ::socketpair(PF_UNIX, SOCK_STREAM, 0, socks));
+
+            boost::shared_ptr<Socket> client(new Socket(socks[0], SockAddr()));
+            boost::shared_ptr<Socket> server(new Socket(socks[1], SockAddr()));
+            client->setHandshakeReceived();
+            server->setHandshakeReceived();
+
+            _server.reset(new MessagingPort(server));
+            _client.reset(new AsyncMessagingPort(
+                boost::shared_ptr<MessagingPort>(new MessagingPort(client))));
+        }
+
+        void tearDown() {
+            _client.reset();
+            _server.reset();
+        }
+
+        boost::scoped_ptr<MessagingPort> _server;
+        boost::scoped_ptr<AsyncMessagingPort> _client;
+    };
+
+    TEST_F(AsyncMessagingPortTest, RepliesRoutedByResponseTo) {
+        Message first;
+        setPayload(&first, "first");
+        boost::shared_ptr<AsyncMessagingPort::Reply> firstReply = _client->call(first);
+
+        Message second;
+        setPayload(&second, "second");
+        boost::shared_ptr<AsyncMessagingPort::Reply> secondReply = _client->call(second);
+
+        Message firstReceived;
+        ASSERT_TRUE(_server->recv(firstReceived));
+        Message secondReceived;
+        ASSERT_TRUE(_server->recv(secondReceived));
+
+        // Answer out of order.
+        Message secondResponse;
+        setPayload(&secondResponse, "reply to second");
+        _server->reply(secondReceived, secondResponse);
+
+        Message response;
+        ASSERT_OK(secondReply->wait(&response));
+        ASSERT_EQUALS("reply to second", payload(response));
+        ASSERT_FALSE(firstReply->isReady());
+
+        Message firstResponse;
+        setPayload(&firstResponse, "reply to first");
+        _server->reply(firstReceived, firstResponse);
+
+        response.reset();
+        ASSERT_OK(firstReply->wait(&response));
+        ASSERT_EQUALS("reply to first", payload(response));
+        ASSERT_EQUALS(0U, _client->getNumPending());
+    }
+
+    TEST_F(AsyncMessagingPortTest, CallbackReceivesReply) {
+        boost::thread server(boost::bind(&echo, _server.get(), 1));
+
+        std::string result;
+        Message request;
+        setPayload(&request, "hello");
+        _client->call(request, boost::bind(&recordReply, &result, _1, _2));
+        server.join();
+
+        // The callback runs on the dispatcher; shutting down waits for it.
+        _client->shutdown();
+        ASSERT_EQUALS("hello", result);
+    }
+
+    TEST_F(AsyncMessagingPortTest, ConcurrentCallers) {
+        const int kCallers = 8;
+        boost::thread server(boost::bind(&echo, _server.get(), kCallers));
+
+        bool ok[kCallers];
+        boost::thread_group callers;
+        for (int i = 0; i < kCallers; ++i)
+            callers.create_thread(boost::bind(&callAndCheck, _client.get(), i, &ok[i]));
+        callers.join_all();
+        server.join();
+
+        for (int i = 0; i < kCallers; ++i)
+            ASSERT_TRUE(ok[i]);
+    }
+
+    TEST_F(AsyncMessagingPortTest, UnknownResponseToIsDropped) {
+        Message request;
+        setPayload(&request, "request");
+        boost::shared_ptr<AsyncMessagingPort::Reply> reply = _client->call(request);
+
+        Message received;
+        ASSERT_TRUE(_server->recv(received));
+
+        Message stray;
+        setPayload(&stray, "stray");
+        _server->reply(received, stray, received.header().getId() + 1000);
+
+        Message response;
+        setPayload(&response, "response");
+        _server->reply(received, response);
+
+        Message got;
+        ASSERT_OK(reply->wait(&got));
+        ASSERT_EQUALS("response", payload(got));
+    }
+
+    TEST_F(AsyncMessagingPortTest, PeerCloseFailsPendingRequests) {
+        Message request;
+        setPayload(&request, "request");
+        boost::shared_ptr<AsyncMessagingPort::Reply> reply = _client->call(request);
+
+        _server->shutdown();
+
+        Message response;
+        ASSERT_EQUALS(ErrorCodes::HostUnreachable, reply->wait(&response).code());
+        ASSERT_TRUE(response.empty());
+    }
+
+    TEST_F(AsyncMessagingPortTest, CallAfterShutdownFails) {
+        _client->shutdown();
+
+        Message request;
+        setPayload(&request, "request");
+        boost::shared_ptr<AsyncMessagingPort::Reply> reply = _client->call(request);
+
+        ASSERT_TRUE(reply->isReady());
+        Message response;
+        ASSERT_EQUALS(ErrorCodes::ShutdownInProgress, reply->wait(&response).code());
+    }
+#endif
+
+} // namespace
@@ -19,6 +19,7 @@
 
 #include "mongo/util/net/message.h"
 
+#include <boost/thread/locks.hpp>
 #include <fcntl.h>
 #include <errno.h>
 #include <time.h>
@@ -27,6 +28,65 @@
 
 namespace mongo {
 
+    const size_t RecvBufferPool::kMaxCachedBufferBytes;
+    const size_t RecvBufferPool::kMaxCachedBuffers;
+
+    void RecvBuffer::Holder::_recycle() {
+        boost::intrusive_ptr<RecvBufferPool> pool;
+        pool.swap(_pool);
+        if (!pool || !pool->_giveBack(this))
+            RecvBufferPool::_destroy(this);
+    }
+
+    RecvBufferPool::~RecvBufferPool() {
+        for (size_t i = 0; i < _cached.size(); ++i)
+            _destroy(_cached[i]);
+    }
+
+    RecvBuffer RecvBufferPool::acquire(size_t minCapacity) {
+        RecvBuffer::Holder* holder = NULL;
+        {
+            boost::lock_guard<boost::mutex> lk(_mutex);
+            for (size_t i = _cached.size(); i > 0; --i) {
+                if (_cached[i - 1]->capacity() >= minCapacity) {
+                    holder = _cached[i - 1];
+                    _cached.erase(_cached.begin() + (i - 1));
+                    break;
+                }
+            }
+        }
+
+        if (holder) {
+            holder->_refCount.store(1U);
+        }
+        else {
+            // round up to 1KB, like the allocations this replaces
+            const size_t capacity = (minCapacity + 1023) & ~size_t(1023);
+            void* storage = malloc(sizeof(RecvBuffer::Holder) + capacity);
+            verify(storage);
+            holder = new(storage) RecvBuffer::Holder(capacity);
+        }
+
+        holder->_pool = this;
+        return RecvBuffer(holder);
+    }
+
+    bool RecvBufferPool::_giveBack(RecvBuffer::Holder* holder) {
+        if (holder->capacity() > kMaxCachedBufferBytes)
+            return false;
+
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        if (_cached.size() >= kMaxCachedBuffers)
+            return false;
+        _cached.push_back(holder);
+        return true;
+    }
+
+    void RecvBufferPool::_destroy(RecvBuffer::Holder* holder) {
+        holder->~Holder();
+        free(holder);
+    }
+
     void Message::send( MessagingPort &p, const char *context ) {
         if ( empty() ) {
             return;
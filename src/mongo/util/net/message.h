@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <boost/intrusive_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include <vector>
 
 #include "mongo/platform/atomic_word.h"
@@ -54,6 +56,7 @@ namespace mongo {
         case dbGetMore: return "getmore";
         case dbDelete: return "remove";
         case dbKillCursors: return "killcursors";
+        case dbCompressed: return "compressed";
         default:
             massert( 16141, str::stream() << "cannot translate opcode " << op, !op );
             return "";
@@ -69,6 +72,7 @@ namespace mongo {
         case dbQuery:
         case dbGetMore:
         case dbKillCursors:
+        case dbCompressed:
             return false;
 
         case dbUpdate:
@@ -295,6 +299,120 @@ namespace mongo {
         }
     } // namespace MsgData
 
+    class RecvBufferPool;
+
+    /**
+     * A reference counted buffer obtained from a RecvBufferPool. When the last reference goes
+     * away the memory is handed back to the pool it came from for reuse, or freed if that pool
+     * has no room for it.
+     */
+    class RecvBuffer {
+    public:
+        RecvBuffer() {}
+
+        void swap(RecvBuffer& other) {
+            _holder.swap(other._holder);
+        }
+
+        void reset() {
+            _holder.reset();
+        }
+
+        char* get() const {
+            return _holder ? _holder->data() : NULL;
+        }
+
+        size_t capacity() const {
+            return _holder ? _holder->capacity() : 0;
+        }
+
+        class Holder {
+        public:
+            explicit Holder(size_t capacity) : _refCount(1U), _capacity(capacity) {}
+
+            // these are called automatically by boost::intrusive_ptr
+            friend void intrusive_ptr_add_ref(Holder* h) {
+                h->_refCount.fetchAndAdd(1);
+            }
+
+            friend void intrusive_ptr_release(Holder* h) {
+                if (h->_refCount.subtractAndFetch(1) == 0)
+                    h->_recycle();
+            }
+
+            char* data() {
+                return reinterpret_cast<char *>(this + 1);
+            }
+
+            size_t capacity() const {
+                return _capacity;
+            }
+
+        private:
+            friend class RecvBufferPool;
+
+            // Returns this buffer to its pool, or destroys it if that is not possible.
+            void _recycle();
+
+            AtomicUInt32 _refCount;
+            const size_t _capacity;
+            // Only set while the buffer is checked out of its pool.
+            boost::intrusive_ptr<RecvBufferPool> _pool;
+        };
+
+    private:
+        friend class RecvBufferPool;
+
+        explicit RecvBuffer(Holder* holder)
+            : _holder(holder, /*add_ref=*/ false) {}
+
+        boost::intrusive_ptr<Holder> _holder;
+    };
+
+    /**
+     * A small cache of receive buffers, owned by a MessagingPort, so that replies do not each
+     * cost a malloc and free. Buffers checked out of the pool keep it alive, so a Message may
+     * safely outlive the port that received it.
+     */
+    class RecvBufferPool {
+    public:
+        /** Buffers larger than this are freed rather than cached. */
+        static const size_t kMaxCachedBufferBytes = 1024 * 1024;
+
+        /** The number of idle buffers the pool holds on to. */
+        static const size_t kMaxCachedBuffers = 2;
+
+        RecvBufferPool() : _refCount(0) {}
+        ~RecvBufferPool();
+
+        /**
+         * Returns a buffer with room for at least 'minCapacity' bytes, reusing a cached buffer
+         * when one is large enough.
+         */
+        RecvBuffer acquire(size_t minCapacity);
+
+        friend void intrusive_ptr_add_ref(RecvBufferPool* p) {
+            p->_refCount.fetchAndAdd(1);
+        }
+
+        friend void intrusive_ptr_release(RecvBufferPool* p) {
+            if (p->_refCount.subtractAndFetch(1) == 0)
+                delete p;
+        }
+
+    private:
+        friend class RecvBuffer::Holder;
+
+        // Takes ownership of 'holder' if there is room for it in the cache.
+        bool _giveBack(RecvBuffer::Holder* holder);
+
+        static void _destroy(RecvBuffer::Holder* holder);
+
+        AtomicUInt32 _refCount;
+        boost::mutex _mutex;
+        std::vector<RecvBuffer::Holder*> _cached;
+    };
+
     class Message {
     public:
         // we assume here that a vector with initial size 0 does no allocation (0 is the default, but wanted to make it explicit).
@@ -371,8 +489,10 @@ namespace mongo {
             verify( r._freeIt );
             _buf = r._buf;
             r._buf = 0;
+            _recvBuffer.swap( r._recvBuffer );
             if ( r._data.size() > 0 ) {
                 _data.swap( r._data );
+                _owned.swap( r._owned );
             }
             r._freeIt = false;
             _freeIt = true;
@@ -381,16 +501,21 @@ namespace mongo {
 
         void reset() {
             if ( _freeIt ) {
-                if ( _buf ) {
+                if ( _recvBuffer.get() ) {
+                    _recvBuffer.reset();
+                }
+                else if ( _buf ) {
                     free( _buf );
                 }
-                for (std::vector< std::pair< char *, int > >::const_iterator i = _data.begin();
-                     i != _data.end(); ++i) {
-                    free(i->first);
+                for (size_t i = 0; i < _data.size(); ++i) {
+                    if ( _owned[i] ) {
+                        free(_data[i].first);
+                    }
                 }
             }
             _buf = 0;
             _data.clear();
+            _owned.clear();
             _freeIt = false;
         }
 
@@ -406,13 +531,18 @@ namespace mongo {
                 _setData( md.view2ptr(), true );
                 return;
             }
-            verify( _freeIt );
-            if ( _buf ) {
-                _data.push_back(std::make_pair(_buf, MsgData::ConstView(_buf).getLen()));
-                _buf = 0;
+            _appendData(d, size, true);
+        }
+
+        // use to add a buffer the message does not own; it is sent in place, as its own
+        // scatter-gather segment, so it must stay valid until the message has been sent.
+        // the first buffer, which holds the header, must still come from appendData/setData
+        void appendBorrowedData(const char *d, int size) {
+            if ( size <= 0 ) {
+                return;
             }
-            _data.push_back(std::make_pair(d, size));
-            header().setLen(header().getLen() + size);
+            verify( !empty() );
+            _appendData(const_cast<char*>(d), size, false);
         }
 
         // use to set first buffer if empty
@@ -420,6 +550,12 @@ namespace mongo {
             verify( empty() );
             _setData( d, freeIt );
         }
+        // use to set first buffer if empty, sharing ownership of 'buf' rather than copying it
+        void setData(const RecvBuffer& buf) {
+            verify( empty() );
+            _recvBuffer = buf;
+            _setData( _recvBuffer.get(), true );
+        }
         void setData(int operation, const char *msgtxt) {
             setData(operation, msgtxt, strlen(msgtxt)+1);
         }
@@ -437,6 +573,31 @@ namespace mongo {
             return _freeIt;
         }
 
+        // the number of buffers the message is held in, header first, as they are sent
+        int numBuffers() const {
+            return _buf ? 1 : static_cast<int>( _data.size() );
+        }
+
+        // the i-th of the numBuffers() buffers holding the message, and its size
+        std::pair< const char*, int > buffer( int i ) const {
+            if ( _buf )
+                return std::make_pair( _buf, MsgData::ConstView(_buf).getLen() );
+            return std::make_pair( _data[ i ].first, _data[ i ].second );
+        }
+
+        // copies the whole message, header included, to 'dest', which must have room for
+        // size() bytes
+        void copyTo( char* dest ) const {
+            if ( _buf ) {
+                memcpy( dest, _buf, size() );
+                return;
+            }
+            for (MsgVec::const_iterator it = _data.begin(); it != _data.end(); ++it) {
+                memcpy( dest, it->first, it->second );
+                dest += it->second;
+            }
+        }
+
         void send( MessagingPort &p, const char *context );
         
         std::string toString() const;
@@ -446,12 +607,28 @@ namespace mongo {
             _freeIt = freeIt;
             _buf = d;
         }
+        void _appendData( char* d, int size, bool owned ) {
+            verify( _freeIt );
+            verify( !_recvBuffer.get() );
+            if ( _buf ) {
+                _data.push_back(std::make_pair(_buf, MsgData::ConstView(_buf).getLen()));
+                _owned.push_back(true);
+                _buf = 0;
+            }
+            _data.push_back(std::make_pair(d, size));
+            _owned.push_back(owned);
+            header().setLen(header().getLen() + size);
+        }
         // if just one buffer, keep it in _buf, otherwise keep a sequence of buffers in _data
         char* _buf;
         // byte buffer(s) - the first must contain at least a full MsgData unless using _buf for storage instead
         typedef std::vector< std::pair< char*, int > > MsgVec;
         MsgVec _data;
+        // parallel to _data: false for buffers added with appendBorrowedData
+        std::vector<bool> _owned;
         bool _freeIt;
+        // set if _buf is borrowed from a MessagingPort's receive buffer pool
+        RecvBuffer _recvBuffer;
     };
 
 
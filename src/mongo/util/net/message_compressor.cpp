@@ -0,0 +1,289 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_compressor.h"
+
+#include "mongo/config.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#ifdef MONGO_ZLIB
+#include <zlib.h>
+#endif
+
+#include "mongo/base/data_view.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/message.h"
+
+namespace mongo {
+
+namespace {
+
+    // Sizes of the fields of an OP_COMPRESSED message after its header.
+    const int kCompressedHeaderSize = sizeof(MSGHEADER::Value) + 4 + 4 + 1;
+
+    // Commands which must be sent uncompressed, so that a server which has not yet negotiated
+    // compression, or which authenticates before decompressing, can read them.
+    const char* const kUncompressibleCommands[] = {
+        "isMaster",
+        "ismaster",
+        "saslStart",
+        "saslContinue",
+        "getnonce",
+        "authenticate",
+        "createUser",
+        "updateUser",
+        "copydbSaslStart",
+        "copydbgetnonce",
+        "copydb",
+    };
+
+    // Returns true if the message in 'data', of 'len' bytes, is a command that must be sent
+    // uncompressed.
+    bool isUncompressibleCommand(const char* data, int len) {
+        const char* const end = data + len;
+
+        // OP_QUERY: flags, then the namespace, skip, limit and the query.
+        const char* ns = data + sizeof(MSGHEADER::Value) + 4;
+        if (ns >= end)
+            return false;
+        const char* nsEnd = static_cast<const char*>(std::memchr(ns, '\0', end - ns));
+        if (!nsEnd)
+            return false;
+        const StringData nsData(ns, nsEnd - ns);
+        if (!nsData.endsWith(".$cmd"))
+            return false;
+
+        // The first field name of the query is the command name.
+        const char* name = nsEnd + 1 + 4 + 4 + 4 + 1;
+        if (name >= end)
+            return false;
+        const char* nameEnd = static_cast<const char*>(std::memchr(name, '\0', end - name));
+        if (!nameEnd)
+            return false;
+        const StringData nameData(name, nameEnd - name);
+        for (size_t i = 0; i < sizeof(kUncompressibleCommands) / sizeof(*kUncompressibleCommands);
+             ++i) {
+            if (nameData == kUncompressibleCommands[i])
+                return true;
+        }
+        return false;
+    }
+
+    // Returns the i-th buffer of 'm' less the message header, which is in the first.
+    std::pair<const char*, int> bodyBuffer(const Message& m, int i) {
+        std::pair<const char*, int> buffer = m.buffer(i);
+        if (i == 0) {
+            buffer.first += sizeof(MSGHEADER::Value);
+            buffer.second -= sizeof(MSGHEADER::Value);
+        }
+        return buffer;
+    }
+
+#ifdef MONGO_ZLIB
+    // Deflates the body of 'in' a buffer at a time into 'out', which has room for 'outLen'
+    // bytes, and sets 'compressedLen' to the size written. Returns the zlib status, which is
+    // Z_STREAM_END on success.
+    int zlibCompress(const Message& in, char* out, int outLen, int* compressedLen) {
+        z_stream stream;
+        std::memset(&stream, 0, sizeof(stream));
+        int status = deflateInit(&stream, Z_DEFAULT_COMPRESSION);
+        if (status != Z_OK)
+            return status;
+
+        stream.next_out = reinterpret_cast<Bytef*>(out);
+        stream.avail_out = outLen;
+
+        const int numBuffers = in.numBuffers();
+        for (int i = 0; i < numBuffers; ++i) {
+            const bool last = i + 1 == numBuffers;
+            const std::pair<const char*, int> body = bodyBuffer(in, i);
+            if (body.second == 0 && !last)
+                continue;
+
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(body.first));
+            stream.avail_in = body.second;
+            status = deflate(&stream, last ? Z_FINISH : Z_NO_FLUSH);
+            if (status != (last ? Z_STREAM_END : Z_OK))
+                break;
+        }
+
+        *compressedLen = static_cast<int>(stream.total_out);
+        deflateEnd(&stream);
+        return status;
+    }
+#endif
+
+} // namespace
+
+    MessageCompressionStats::MessageCompressionStats()
+        : messagesSent(0)
+        , bytesSent(0)
+        , uncompressedBytesSent(0)
+        , messagesReceived(0)
+        , bytesReceived(0)
+        , uncompressedBytesReceived(0)
+    {}
+
+    std::vector<std::string> supportedMessageCompressors() {
+        std::vector<std::string> names;
+#ifdef MONGO_ZLIB
+        names.push_back("zlib");
+#endif
+        names.push_back("noop");
+        return names;
+    }
+
+    bool findMessageCompressor(const StringData& name, MessageCompressorId* id) {
+        if (name == "noop") {
+            *id = kNoopMessageCompressor;
+            return true;
+        }
+#ifdef MONGO_ZLIB
+        if (name == "zlib") {
+            *id = kZlibMessageCompressor;
+            return true;
+        }
+#endif
+        return false;
+    }
+
+    bool compressMessage(MessageCompressorId compressor, const Message& in, Message* out) {
+        verify(out->empty());
+
+        const int operation = in.operation();
+        if (operation == dbCompressed)
+            return false;
+
+        // The message is read where it is, so that documents sent in place are not copied.
+        // The header, and the name of any command, are in the first buffer.
+        const std::pair<const char*, int> first = in.buffer(0);
+        if (operation == dbQuery && isUncompressibleCommand(first.first, first.second))
+            return false;
+
+        const int dataLen = in.dataSize();
+        int maxCompressedLen = dataLen;
+#ifdef MONGO_ZLIB
+        if (compressor == kZlibMessageCompressor)
+            maxCompressedLen = compressBound(dataLen);
+#endif
+
+        MsgData::View compressed = static_cast<char*>(
+            std::malloc(kCompressedHeaderSize + maxCompressedLen));
+        char* const compressedData = compressed.view2ptr() + kCompressedHeaderSize;
+        int compressedLen = 0;
+
+        switch (compressor) {
+        case kNoopMessageCompressor:
+            for (int i = 0; i < in.numBuffers(); ++i) {
+                const std::pair<const char*, int> body = bodyBuffer(in, i);
+                std::memcpy(compressedData + compressedLen, body.first, body.second);
+                compressedLen += body.second;
+            }
+            break;
+#ifdef MONGO_ZLIB
+        case kZlibMessageCompressor: {
+            const int status = zlibCompress(in, compressedData, maxCompressedLen,
+                                            &compressedLen);
+            if (status != Z_STREAM_END) {
+                std::free(compressed.view2ptr());
+                uasserted(0, str::stream() << "zlib failed to compress a message: " << status);
+            }
+            break;
+        }
+#endif
+        default:
+            std::free(compressed.view2ptr());
+            uasserted(0, str::stream() << "message compressor " << int(compressor)
+                                       << " is not supported by this build");
+        }
+
+        compressed.setLen(kCompressedHeaderSize + compressedLen);
+        compressed.setId(in.header().getId());
+        compressed.setResponseTo(in.header().getResponseTo());
+        compressed.setOperation(dbCompressed);
+
+        DataView fields(compressed.data());
+        fields.writeLE<int32_t>(operation, 0);
+        fields.writeLE<int32_t>(dataLen, 4);
+        fields.writeLE<uint8_t>(compressor, 8);
+
+        out->setData(compressed.view2ptr(), true);
+        return true;
+    }
+
+    void decompressMessage(const Message& in, Message* out) {
+        verify(out->empty());
+
+        const MsgData::ConstView compressed = in.singleData();
+        const int len = compressed.getLen();
+        uassert(0, "OP_COMPRESSED message is too short", len >= kCompressedHeaderSize);
+
+        ConstDataView fields(compressed.data());
+        const int32_t operation = fields.readLE<int32_t>(0);
+        const int32_t dataLen = fields.readLE<int32_t>(4);
+        const uint8_t compressor = fields.readLE<uint8_t>(8);
+        uassert(0, str::stream() << "OP_COMPRESSED message has an invalid size: " << dataLen,
+                dataLen >= 0 && static_cast<size_t>(dataLen) <=
+                    MaxMessageSizeBytes - sizeof(MSGHEADER::Value));
+
+        const char* const compressedData = compressed.view2ptr() + kCompressedHeaderSize;
+        const int compressedLen = len - kCompressedHeaderSize;
+
+        MsgData::View decompressed = static_cast<char*>(
+            std::malloc(sizeof(MSGHEADER::Value) + dataLen));
+        char* const data = decompressed.view2ptr() + sizeof(MSGHEADER::Value);
+
+        switch (compressor) {
+        case kNoopMessageCompressor:
+            if (compressedLen != dataLen) {
+                std::free(decompressed.view2ptr());
+                uasserted(0, "OP_COMPRESSED message is not the size it claims");
+            }
+            std::memcpy(data, compressedData, dataLen);
+            break;
+#ifdef MONGO_ZLIB
+        case kZlibMessageCompressor: {
+            uLongf zlibLen = dataLen;
+            const int status = uncompress(reinterpret_cast<Bytef*>(data), &zlibLen,
+                                          reinterpret_cast<const Bytef*>(compressedData),
+                                          compressedLen);
+            if (status != Z_OK || zlibLen != static_cast<uLongf>(dataLen)) {
+                std::free(decompressed.view2ptr());
+                uasserted(0, str::stream() << "zlib failed to decompress a message: "
+                                           << status);
+            }
+            break;
+        }
+#endif
+        default:
+            std::free(decompressed.view2ptr());
+            uasserted(0, str::stream() << "message compressor " << int(compressor)
+                                       << " is not supported by this build");
+        }
+
+        decompressed.setLen(sizeof(MSGHEADER::Value) + dataLen);
+        decompressed.setId(compressed.getId());
+        decompressed.setResponseTo(compressed.getResponseTo());
+        decompressed.setOperation(operation);
+        out->setData(decompressed.view2ptr(), true);
+    }
+
+} // namespace mongo
@@ -0,0 +1,84 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/client/export_macros.h"
+
+namespace mongo {
+
+    class Message;
+
+    /**
+     * Algorithms an OP_COMPRESSED message may be compressed with, numbered as on the wire.
+     *
+     * An OP_COMPRESSED message holds another message, less its header, after a header of its
+     * own and these fields:
+     *
+     *     int32 originalOpcode;     // operation of the message compressed
+     *     int32 uncompressedSize;   // size of the message compressed, less its header
+     *     uint8 compressorId;       // a MessageCompressorId
+     *     char  compressedMessage[];
+     *
+     * The requestID and responseTo of the message compressed are those of the OP_COMPRESSED
+     * message.
+     */
+    enum MessageCompressorId {
+        kNoopMessageCompressor = 0,
+        kSnappyMessageCompressor = 1,
+        kZlibMessageCompressor = 2
+    };
+
+    /** Bytes sent and received in OP_COMPRESSED messages on a connection. */
+    struct MONGO_CLIENT_API MessageCompressionStats {
+        MessageCompressionStats();
+
+        long long messagesSent;
+        long long bytesSent;                 // as sent, compressed
+        long long uncompressedBytesSent;     // as they would have been sent uncompressed
+
+        long long messagesReceived;
+        long long bytesReceived;
+        long long uncompressedBytesReceived;
+    };
+
+    /**
+     * @return the names of the compressors this build supports, most preferred first, as
+     * negotiated in the "compression" field of isMaster.
+     */
+    std::vector<std::string> supportedMessageCompressors();
+
+    /** Sets 'id' to the compressor called 'name', or returns false if it is not supported. */
+    bool findMessageCompressor(const StringData& name, MessageCompressorId* id);
+
+    /**
+     * Sets 'out' to an OP_COMPRESSED message holding 'in' compressed with 'compressor'.
+     *
+     * @return false, leaving 'out' empty, if 'in' must be sent uncompressed: it is already
+     * compressed, or a command used in the handshake or in authentication.
+     */
+    bool compressMessage(MessageCompressorId compressor, const Message& in, Message* out);
+
+    /**
+     * Sets 'out' to the message held by the OP_COMPRESSED message 'in'. Throws a
+     * UserException if 'in' is malformed or uses a compressor this build does not support.
+     */
+    void decompressMessage(const Message& in, Message* out);
+
+} // namespace mongo
@@ -0,0 +1,152 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_compressor.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "mongo/config.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/net/message.h"
+
+namespace {
+
+    using namespace mongo;
+
+    // Builds an OP_QUERY of 'query' on 'ns'.
+    void makeQuery(Message* m, const std::string& ns, const BSONObj& query) {
+        BufBuilder b;
+        b.appendNum(0);
+        b.appendStr(ns);
+        b.appendNum(0);
+        b.appendNum(-1);
+        query.appendSelfToBufBuilder(b);
+        m->setData(dbQuery, b.buf(), b.len());
+        m->header().setId(1234);
+        m->header().setResponseTo(5678);
+    }
+
+    std::string contents(const Message& m) {
+        std::string bytes(m.size(), '\0');
+        m.copyTo(&bytes[0]);
+        return bytes;
+    }
+
+    void assertRoundTrips(MessageCompressorId compressor, const Message& original) {
+        Message compressed;
+        ASSERT_TRUE(compressMessage(compressor, original, &compressed));
+        ASSERT_EQUALS(dbCompressed, compressed.operation());
+        ASSERT_EQUALS(original.header().getId(), compressed.header().getId());
+        ASSERT_EQUALS(original.header().getResponseTo(), compressed.header().getResponseTo());
+
+        Message decompressed;
+        decompressMessage(compressed, &decompressed);
+        ASSERT_EQUALS(contents(original), contents(decompressed));
+    }
+
+    TEST(MessageCompressor, NoopRoundTrips) {
+        Message m;
+        makeQuery(&m, "test.foo", BSON("a" << std::string(1000, 'x')));
+        assertRoundTrips(kNoopMessageCompressor, m);
+    }
+
+    TEST(MessageCompressor, MultipleBuffersRoundTrip) {
+        const std::string borrowed(5000, 'b');
+        Message m;
+        makeQuery(&m, "test.foo", BSON("a" << 1));
+        m.appendBorrowedData(borrowed.data(), borrowed.size());
+        assertRoundTrips(kNoopMessageCompressor, m);
+    }
+
+#ifdef MONGO_ZLIB
+    TEST(MessageCompressor, ZlibRoundTripsAndShrinks) {
+        Message m;
+        makeQuery(&m, "test.foo", BSON("a" << std::string(10000, 'x')));
+        assertRoundTrips(kZlibMessageCompressor, m);
+
+        Message compressed;
+        ASSERT_TRUE(compressMessage(kZlibMessageCompressor, m, &compressed));
+        ASSERT_LESS_THAN(compressed.size(), m.size() / 10);
+    }
+
+    TEST(MessageCompressor, ZlibMultipleBuffersRoundTrip) {
+        const std::string first(3000, 'f');
+        const std::string second(7000, 's');
+        Message m;
+        makeQuery(&m, "test.foo", BSON("a" << 1));
+        m.appendBorrowedData(first.data(), first.size());
+        m.appendBorrowedData(second.data(), second.size());
+        assertRoundTrips(kZlibMessageCompressor, m);
+    }
+
+    TEST(MessageCompressor, ZlibRejectsCorruptMessage) {
+        Message m;
+        makeQuery(&m, "test.foo", BSON("a" << std::string(1000, 'x')));
+        Message compressed;
+        ASSERT_TRUE(compressMessage(kZlibMessageCompressor, m, &compressed));
+
+        char* data = compressed.singleData().data();
+        std::fill(data + 9, data + 20, 'z');
+        Message decompressed;
+        ASSERT_THROWS(decompressMessage(compressed, &decompressed), UserException);
+    }
+#endif
+
+    TEST(MessageCompressor, HandshakeAndAuthCommandsAreNotCompressed) {
+        Message isMaster;
+        makeQuery(&isMaster, "admin.$cmd", BSON("isMaster" << 1));
+        Message saslStart;
+        makeQuery(&saslStart, "admin.$cmd", BSON("saslStart" << 1 << "payload" << "x"));
+        Message compressed;
+        ASSERT_FALSE(compressMessage(kNoopMessageCompressor, isMaster, &compressed));
+        ASSERT_FALSE(compressMessage(kNoopMessageCompressor, saslStart, &compressed));
+        ASSERT_TRUE(compressed.empty());
+
+        Message count;
+        makeQuery(&count, "admin.$cmd", BSON("count" << "foo"));
+        ASSERT_TRUE(compressMessage(kNoopMessageCompressor, count, &compressed));
+    }
+
+    TEST(MessageCompressor, RejectsBadUncompressedSize) {
+        Message m;
+        makeQuery(&m, "test.foo", BSON("a" << 1));
+        Message compressed;
+        ASSERT_TRUE(compressMessage(kNoopMessageCompressor, m, &compressed));
+
+        DataView(compressed.singleData().data()).writeLE<int32_t>(m.size(), 4);
+        Message decompressed;
+        ASSERT_THROWS(decompressMessage(compressed, &decompressed), UserException);
+    }
+
+    TEST(MessageCompressor, FindsSupportedCompressorsByName) {
+        const std::vector<std::string> names = supportedMessageCompressors();
+        for (size_t i = 0; i < names.size(); ++i) {
+            MessageCompressorId id;
+            ASSERT_TRUE(findMessageCompressor(names[i], &id));
+        }
+
+        MessageCompressorId id;
+        ASSERT_TRUE(findMessageCompressor("noop", &id));
+        ASSERT_EQUALS(kNoopMessageCompressor, id);
+        ASSERT_FALSE(findMessageCompressor("lzma", &id));
+    }
+
+} // namespace
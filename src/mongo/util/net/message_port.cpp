@@ -23,6 +23,7 @@
 
 #include <boost/thread/locks.hpp>
 #include <boost/thread/mutex.hpp>
+#include <algorithm>
 #include <fcntl.h>
 #include <set>
 #include <time.h>
@@ -32,7 +33,6 @@
 #include "mongo/util/log.h"
 #include "mongo/util/net/message.h"
 #include "mongo/util/net/ssl_manager.h"
-#include "mongo/util/scopeguard.h"
 #include "mongo/util/time_support.h"
 
 #ifndef _WIN32
@@ -83,6 +83,8 @@ namespace mongo {
             if ( len() + m.header().getLen() > 1300 )
                 flush();
 
+            // small enough that flattening a scatter-gather message costs next to nothing
+            m.concat();
             memcpy( _cur , m.singleData().view2ptr() , m.header().getLen() );
             _cur += m.header().getLen();
         }
@@ -135,18 +137,22 @@ namespace mongo {
     }
 
     MessagingPort::MessagingPort(int fd, const SockAddr& remote) 
-        : psock( new Socket( fd , remote ) ) , piggyBackData(0) {
+        : psock( new Socket( fd , remote ) ) , piggyBackData(0),
+          _recvBuffers( new RecvBufferPool() ), _compressing( false ),
+          _compressor( kNoopMessageCompressor ) {
         ports.insert(this);
     }
 
     MessagingPort::MessagingPort( double timeout, logger::LogSeverity ll ) 
-        : psock( new Socket( timeout, ll ) ) {
+        : psock( new Socket( timeout, ll ) ), piggyBackData( 0 ),
+          _recvBuffers( new RecvBufferPool() ), _compressing( false ),
+          _compressor( kNoopMessageCompressor ) {
         ports.insert(this);
-        piggyBackData = 0;
     }
 
     MessagingPort::MessagingPort( boost::shared_ptr<Socket> sock )
-        : psock( sock ), piggyBackData( 0 ) {
+        : psock( sock ), piggyBackData( 0 ), _recvBuffers( new RecvBufferPool() ),
+          _compressing( false ), _compressor( kNoopMessageCompressor ) {
         ports.insert(this);
     }
 
@@ -165,14 +171,39 @@ namespace mongo {
         ports.erase(this);
     }
     
+    namespace {
+        // Size of the buffer the header is read into. Whatever part of the body has already
+        // arrived is read along with the header, so most small replies take a single recv.
+        const size_t kInitialRecvBufferBytes = 16 * 1024;
+    } // namespace
+
+    int MessagingPort::_takeReadAhead(char* buf, int max) {
+        const int n = std::min(max, static_cast<int>(_readAhead.size()));
+        if (n > 0) {
+            memcpy(buf, &_readAhead[0], n);
+            _readAhead.erase(_readAhead.begin(), _readAhead.begin() + n);
+        }
+        return n;
+    }
+
     bool MessagingPort::recv(Message& m) {
         try {
 again:
             //mmm( log() << "*  recv() sock:" << this->sock << endl; )
-            MSGHEADER::Value header;
-            int headerLen = sizeof(MSGHEADER::Value);
-            psock->recv( (char *)&header, headerLen );
-            int len = header.constView().getMessageLength();
+            const int headerLen = sizeof(MSGHEADER::Value);
+            RecvBuffer buf = _recvBuffers->acquire(
+                std::max(kInitialRecvBufferBytes, _readAhead.size()));
+
+            // Until the handshake is done the bytes after the header may not be ours to read.
+            const int maxRead = psock->isAwaitingHandshake() ?
+                headerLen : static_cast<int>(buf.capacity());
+            int have = _takeReadAhead(buf.get(), maxRead);
+            while (have < headerLen) {
+                have += psock->unsafe_recv(buf.get() + have, maxRead - have);
+            }
+
+            MSGHEADER::ConstView header(buf.get());
+            int len = header.getMessageLength();
 
             if ( len == 542393671 ) {
                 // an http GET
@@ -186,6 +217,7 @@ again:
             }
             else if ( len == -1 ) {
                 // Endian check from the client, after connecting, to see what mode server is running in.
+                _readAhead.insert(_readAhead.begin(), buf.get() + headerLen, buf.get() + have);
                 unsigned foo = 0x10203040;
                 send( (char *) &foo, 4, "endian" );
                 psock->setHandshakeReceived();
@@ -194,19 +226,18 @@ again:
             // If responseTo is not 0 or -1 for first packet assume SSL
             else if (psock->isAwaitingHandshake()) {
 #ifndef MONGO_SSL
-                if (header.constView().getResponseTo() != 0
-                 && header.constView().getResponseTo() != -1) {
+                if (header.getResponseTo() != 0
+                 && header.getResponseTo() != -1) {
                     uasserted(17133,
                               "SSL handshake requested, SSL feature not available in this build");
                 }
 #else                    
-                if (header.constView().getResponseTo() != 0
-                 && header.constView().getResponseTo() != -1) {
+                if (header.getResponseTo() != 0
+                 && header.getResponseTo() != -1) {
                     uassert(17132,
                             "SSL handshake received but initialized without SSL support",
                             client::Options::current().SSLEnabled());
-                    setX509SubjectName(psock->doSSLHandshake(
-                                       reinterpret_cast<const char*>(&header), sizeof(header)));
+                    setX509SubjectName(psock->doSSLHandshake(buf.get(), headerLen));
                     psock->setHandshakeReceived();
                     goto again;
                 }
@@ -222,19 +253,39 @@ again:
             }
 
             psock->setHandshakeReceived();
-            int z = (len+1023)&0xfffffc00;
-            verify(z>=len);
-            MsgData::View md = reinterpret_cast<char *>(malloc(z));
-            ScopeGuard guard = MakeGuard(free, md.view2ptr());
-            verify(md.view2ptr());
 
-            memcpy(md.view2ptr(), &header, headerLen);
-            int left = len - headerLen;
+            if ( have > len ) {
+                // we read into the next message; keep those bytes for the next recv
+                _readAhead.insert(_readAhead.begin(), buf.get() + len, buf.get() + have);
+                have = len;
+            }
+            else if ( static_cast<size_t>(len) > buf.capacity() ) {
+                RecvBuffer larger = _recvBuffers->acquire(len);
+                memcpy(larger.get(), buf.get(), have);
+                buf.swap(larger);
+            }
 
-            psock->recv( md.data(), left );
+            psock->recv( buf.get() + have, len - have );
+
+            if ( MSGHEADER::ConstView(buf.get()).getOpCode() == dbCompressed ) {
+                Message compressed;
+                compressed.setData(buf);
+                try {
+                    decompressMessage(compressed, &m);
+                }
+                catch ( const DBException& e ) {
+                    LOG(0) << "recv(): unable to decompress message from " << remote()
+                           << ": " << e.what();
+                    m.reset();
+                    return false;
+                }
+                _compressionStats.messagesReceived++;
+                _compressionStats.bytesReceived += len;
+                _compressionStats.uncompressedBytesReceived += m.size();
+                return true;
+            }
 
-            guard.Dismiss();
-            m.setData(md.view2ptr(), true);
+            m.setData(buf);
             return true;
 
         }
@@ -307,9 +358,28 @@ again:
             }
         }
 
+        sendMessage( toSend );
+    }
+
+    void MessagingPort::sendMessage( Message& toSend ) {
+        if ( _compressing ) {
+            Message compressed;
+            if ( compressMessage( _compressor, toSend, &compressed ) ) {
+                _compressionStats.messagesSent++;
+                _compressionStats.bytesSent += compressed.size();
+                _compressionStats.uncompressedBytesSent += toSend.size();
+                compressed.send( *this, "say" );
+                return;
+            }
+        }
         toSend.send( *this, "say" );
     }
 
+    void MessagingPort::setCompressor( MessageCompressorId compressor ) {
+        _compressing = true;
+        _compressor = compressor;
+    }
+
     void MessagingPort::piggyBack( Message& toSend , int responseTo ) {
 
         if ( toSend.header().getLen() > 1300 ) {
@@ -24,6 +24,7 @@
 #include <vector>
 
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor.h"
 #include "mongo/util/net/sock.h"
 
 namespace mongo {
@@ -106,6 +107,20 @@ namespace mongo {
 
         void piggyBack( Message& toSend , int responseTo = 0 );
 
+        /**
+         * Sends 'toSend', whose id must already be set, compressed if compression is on.
+         */
+        void sendMessage( Message& toSend );
+
+        /**
+         * Compresses messages sent from now on with 'compressor', which the remote end must
+         * have agreed to. Compressed messages received are decompressed whether or not this
+         * is set.
+         */
+        void setCompressor( MessageCompressorId compressor );
+
+        const MessageCompressionStats& compressionStats() const { return _compressionStats; }
+
         unsigned remotePort() const { return psock->remotePort(); }
         virtual HostAndPort remote() const;
         virtual SockAddr remoteAddr() const;
@@ -144,9 +159,22 @@ namespace mongo {
         }
 
     private:
-        
+
+        // Moves up to 'max' bytes of previously over-read data into 'buf'. Returns the count.
+        int _takeReadAhead(char* buf, int max);
+
         PiggyBackData * piggyBackData;
 
+        // Receive buffers are recycled through this pool rather than malloc'd per message.
+        boost::intrusive_ptr<RecvBufferPool> _recvBuffers;
+
+        // Bytes read from the socket past the end of the last message received.
+        std::vector<char> _readAhead;
+
+        bool _compressing;
+        MessageCompressorId _compressor;
+        MessageCompressionStats _compressionStats;
+
         // this is the parsed version of remote
         // mutable because its initialized only on call to remote()
         mutable HostAndPort _remoteParsed; 
@@ -0,0 +1,286 @@
+/*    Copyright 2014 MongoDB Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/net/message_port.h"
+
+#include <boost/scoped_ptr.hpp>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/types.h>
+#endif
+
+#include "mongo/base/data_view.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/net/message_compressor.h"
+
+namespace {
+
+    using namespace mongo;
+
+#ifndef _WIN32
+    class MessagingPortRecvTest : public unittest::Test {
+    protected:
+        void setUp() {
+            int socks[2];
+            ASSERT_EQUALS(0, ::socketpair(PF_UNIX, SOCK_STREAM, 0, socks));
+
+            boost::shared_ptr<Socket> sender(new Socket(socks[0], SockAddr()));
+            boost::shared_ptr<Socket> receiver(new Socket(socks[1], SockAddr()));
+            sender->setHandshakeReceived();
+            receiver->setHandshakeReceived();
+
+            _sender.reset(new MessagingPort(sender));
+            _receiver.reset(new MessagingPort(receiver));
+        }
+
+        void tearDown() {
+            _sender.reset();
+            _receiver.reset();
+        }
+
+        // Sends a dbMsg whose payload is 'size' copies of 'fill'.
+        void sendMessage(size_t size, char fill) {
+            const std::string payload(size, fill);
+            Message toSend;
+            toSend.setData(dbMsg, payload.data(), payload.size());
+            _sender->say(toSend);
+        }
+
+        // Starts a dbMsg with 'head' as its payload, in an owned first buffer that further
+        // buffers may be appended to.
+        void startMessage(Message* m, const std::string& head) {
+            const int len = MsgData::MsgDataHeaderSize + head.size();
+            MsgData::View buf = static_cast<char*>(malloc(len));
+            memcpy(buf.data(), head.data(), head.size());
+            m->appendData(buf.view2ptr(), len);
+            m->header().setOperation(dbMsg);
+        }
+
+        void assertPayload(const Message& m, const std::string& payload) {
+            ASSERT_EQUALS(dbMsg, m.operation());
+            ASSERT_EQUALS(payload, std::string(m.header().data(), m.header().dataLen()));
+        }
+
+        void assertMessage(const Message& m, size_t size, char fill) {
+            ASSERT_EQUALS(dbMsg, m.operation());
+            ASSERT_EQUALS(static_cast<int>(size), m.header().dataLen());
+            ASSERT_EQUALS(std::string(size, fill), std::string(m.header().data(), size));
+        }
+
+        boost::scoped_ptr<MessagingPort> _sender;
+        boost::scoped_ptr<MessagingPort> _receiver;
+    };
+
+    TEST_F(MessagingPortRecvTest, SmallMessage) {
+        sendMessage(100, 'a');
+
+        Message m;
+        ASSERT_TRUE(_receiver->recv(m));
+        assertMessage(m, 100, 'a');
+    }
+
+    TEST_F(MessagingPortRecvTest, MessageLargerThanInitialBuffer) {
+        sendMessage(100 * 1024, 'b');
+
+        Message m;
+        ASSERT_TRUE(_receiver->recv(m));
+        assertMessage(m, 100 * 1024, 'b');
+    }
+
+    TEST_F(MessagingPortRecvTest, BackToBackMessagesAreSplitCorrectly) {
+        sendMessage(10, 'a');
+        sendMessage(20, 'b');
+        sendMessage(30, 'c');
+
+        Message first;
+        ASSERT_TRUE(_receiver->recv(first));
+        Message second;
+        ASSERT_TRUE(_receiver->recv(second));
+        Message third;
+        ASSERT_TRUE(_receiver->recv(third));
+
+        assertMessage(first, 10, 'a');
+        assertMessage(second, 20, 'b');
+        assertMessage(third, 30, 'c');
+    }
+
+    TEST_F(MessagingPortRecvTest, ReleasedBufferIsReused) {
+        sendMessage(100, 'a');
+        sendMessage(100, 'b');
+
+        Message m;
+        ASSERT_TRUE(_receiver->recv(m));
+        const char* firstBuffer = m.singleData().view2ptr();
+        m.reset();
+
+        ASSERT_TRUE(_receiver->recv(m));
+        ASSERT_EQUALS(firstBuffer, m.singleData().view2ptr());
+        assertMessage(m, 100, 'b');
+    }
+
+    TEST_F(MessagingPortRecvTest, MessageOutlivesPort) {
+        sendMessage(100, 'a');
+
+        Message m;
+        ASSERT_TRUE(_receiver->recv(m));
+        _receiver.reset();
+
+        assertMessage(m, 100, 'a');
+    }
+
+    TEST_F(MessagingPortRecvTest, MessageOwnershipTransfers) {
+        sendMessage(100, 'a');
+
+        Message received;
+        ASSERT_TRUE(_receiver->recv(received));
+        Message kept(received);
+        ASSERT_TRUE(received.empty());
+
+        assertMessage(kept, 100, 'a');
+    }
+
+    TEST_F(MessagingPortRecvTest, BorrowedBuffersSentInPlace) {
+        const std::string first(3000, 'b');
+        const std::string second(5000, 'c');
+
+        Message toSend;
+        startMessage(&toSend, "head");
+        toSend.appendBorrowedData(first.data(), first.size());
+        toSend.appendBorrowedData(second.data(), second.size());
+        _sender->say(toSend);
+
+        // Resetting frees only the owned header buffer.
+        toSend.reset();
+
+        Message m;
+        ASSERT_TRUE(_receiver->recv(m));
+        assertPayload(m, "head" + first + second);
+    }
+
+    TEST_F(MessagingPortRecvTest, MoreBuffersThanOneSendmsgTakes) {
+        const std::string segment("xyz");
+        const int kSegments = 5000;
+
+        Message toSend;
+        startMessage(&toSend, "head");
+        for (int i = 0; i < kSegments; ++i)
+            toSend.appendBorrowedData(segment.data(), segment.size());
+        _sender->say(toSend);
+
+        std::string expected("head");
+        for (int i = 0; i < kSegments; ++i)
+            expected += segment;
+
+        Message m;
+        ASSERT_TRUE(_receiver->recv(m));
+        assertPayload(m, expected);
+    }
+
+    TEST_F(MessagingPortRecvTest, MultipleBuffersAfterPiggyBack) {
+        Message piggyBacked;
+        piggyBacked.setData(dbMsg, "queued");
+        _sender->piggyBack(piggyBacked);
+
+        const std::string tail("tail");
+        Message toSend;
+        startMessage(&toSend, "head");
+        toSend.appendBorrowedData(tail.data(), tail.size());
+        _sender->say(toSend);
+
+        Message m;
+        ASSERT_TRUE(_receiver->recv(m));
+        assertPayload(m, std::string("queued", sizeof("queued")));
+        m.reset();
+        ASSERT_TRUE(_receiver->recv(m));
+        assertPayload(m, "headtail");
+    }
+
+    TEST_F(MessagingPortRecvTest, CompressedMessagesAreDecompressed) {
+        _sender->setCompressor(kNoopMessageCompressor);
+
+        const std::string tail(3000, 't');
+        Message toSend;
+        startMessage(&toSend, "head");
+        toSend.appendBorrowedData(tail.data(), tail.size());
+        _sender->say(toSend);
+        const MSGID id = toSend.header().getId();
+        sendMessage(100, 'a');
+
+        Message m;
+        ASSERT_TRUE(_receiver->recv(m));
+        assertPayload(m, "head" + tail);
+        ASSERT_EQUALS(id, m.header().getId());
+        m.reset();
+        ASSERT_TRUE(_receiver->recv(m));
+        assertMessage(m, 100, 'a');
+
+        const MessageCompressionStats& sent = _sender->compressionStats();
+        ASSERT_EQUALS(2, sent.messagesSent);
+        ASSERT_EQUALS(2 * 16 + 4 + 3000 + 100, sent.uncompressedBytesSent);
+        ASSERT_EQUALS(sent.uncompressedBytesSent + 2 * 9, sent.bytesSent);
+
+        const MessageCompressionStats& received = _receiver->compressionStats();
+        ASSERT_EQUALS(2, received.messagesReceived);
+        ASSERT_EQUALS(sent.bytesSent, received.bytesReceived);
+        ASSERT_EQUALS(sent.uncompressedBytesSent, received.uncompressedBytesReceived);
+        ASSERT_EQUALS(0, received.messagesSent);
+    }
+
+    TEST_F(MessagingPortRecvTest, CorruptCompressedMessageFailsRecv) {
+        Message original;
+        original.setData(dbMsg, "payload", 7);
+        Message compressed;
+        ASSERT_TRUE(compressMessage(kNoopMessageCompressor, original, &compressed));
+
+        // Claim a different uncompressed size than the message holds.
+        DataView(compressed.singleData().data()).writeLE<int32_t>(100, 4);
+        _sender->say(compressed);
+
+        Message m;
+        ASSERT_FALSE(_receiver->recv(m));
+        ASSERT_TRUE(m.empty());
+    }
+#endif
+
+    TEST(RecvBufferPool, ReusesReleasedBuffers) {
+        boost::intrusive_ptr<RecvBufferPool> pool(new RecvBufferPool());
+
+        RecvBuffer buf = pool->acquire(100);
+        ASSERT_GREATER_THAN_OR_EQUALS(buf.capacity(), 100U);
+        char* const first = buf.get();
+        buf.reset();
+
+        RecvBuffer again = pool->acquire(100);
+        ASSERT_EQUALS(first, again.get());
+
+        RecvBuffer other = pool->acquire(100);
+        ASSERT_NOT_EQUALS(first, other.get());
+    }
+
+    TEST(RecvBufferPool, BufferOutlivesPool) {
+        boost::intrusive_ptr<RecvBufferPool> pool(new RecvBufferPool());
+        RecvBuffer buf = pool->acquire(100);
+        pool.reset();
+
+        memset(buf.get(), 'x', 100);
+        buf.reset();
+    }
+
+} // namespace
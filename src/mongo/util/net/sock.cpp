@@ -30,6 +30,7 @@
 # include <arpa/inet.h>
 # include <errno.h>
 # include <netdb.h>
+# include <limits.h>
 # if defined(__openbsd__)
 #  include <sys/uio.h>
 # endif
@@ -370,6 +371,14 @@ namespace mongo {
     const int portRecvFlags = 0;
 #endif
 
+#if !defined(_WIN32)
+#ifdef IOV_MAX
+    const size_t kMaxIovecs = IOV_MAX;
+#else
+    const size_t kMaxIovecs = 1024;
+#endif
+#endif
+
     string SocketException::toString() const {
         stringstream ss;
         ss << _ei.code << " socket exception [" << _getStringType(_type) << "] ";
@@ -625,12 +634,20 @@ namespace mongo {
                 _bytesOut += j->second;
             }
         }
-        struct msghdr meta;
-        memset( &meta, 0, sizeof( meta ) );
-        meta.msg_iov = &d[ 0 ];
-        meta.msg_iovlen = d.size();
+        // empty buffers were skipped above
+        d.resize( i );
+
+        // a message assembled from many borrowed buffers can exceed the number of iovecs
+        // sendmsg accepts at once, so hand them over at most kMaxIovecs at a time
+        struct iovec *next = d.empty() ? NULL : &d[ 0 ];
+        size_t remaining = d.size();
+
+        while( remaining > 0 ) {
+            struct msghdr meta;
+            memset( &meta, 0, sizeof( meta ) );
+            meta.msg_iov = next;
+            meta.msg_iovlen = std::min( remaining, kMaxIovecs );
 
-        while( meta.msg_iovlen > 0 ) {
             int ret = -1;
             if (MONGO_FAIL_POINT(throwSockExcep)) {
 #if defined(_WIN32)
@@ -656,17 +673,16 @@ namespace mongo {
                 }
             }
             else {
-                struct iovec *& i = meta.msg_iov;
                 while( ret > 0 ) {
-                    if ( i->iov_len > unsigned( ret ) ) {
-                        i->iov_len -= ret;
-                        i->iov_base = (char*)(i->iov_base) + ret;
+                    if ( next->iov_len > unsigned( ret ) ) {
+                        next->iov_len -= ret;
+                        next->iov_base = (char*)(next->iov_base) + ret;
                         ret = 0;
                     }
                     else {
-                        ret -= i->iov_len;
-                        ++i;
-                        --(meta.msg_iovlen);
+                        ret -= next->iov_len;
+                        ++next;
+                        --remaining;
                     }
                 }
             }